@@ -0,0 +1,178 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include "VectorConfig.h"
+
+#if defined(_MSC_FULL_VER) && _MSC_FULL_VER < 180000000
+#define noexcept throw()
+#endif
+
+const size_t RECYCLER_MIN_CLASS_BYTES = 64;
+const size_t RECYCLER_SIZE_CLASSES = 40; //64 bytes .. 32 TB, larger buffers are never kept
+const size_t RECYCLER_DEFAULT_LIMIT = 64 * 1024 * 1024;
+
+///<summary>
+///Per-thread cache of freed vector buffers, bucketed by power-of-two size classes.
+///A request is rounded up to its class, so a buffer released by one vector can serve the next
+///reserve of any vector of the same class without a trip to malloc.
+///Free buffers are chained through their own first bytes. Retained memory is bounded by limit():
+///a buffer that would exceed it is freed at once. Used by Vectors with StorageOptions::recycled().
+///Not thread safe: every thread works with its own local() instance. Vectors freed after that instance
+///is destroyed at thread exit (a static or thread_local Vector) go through acquireLocal()/releaseLocal(),
+///which fall back to malloc/free.
+///</summary>
+class BufferRecycler {
+private:
+	struct FreeBuffer {
+		FreeBuffer *next;
+	};
+
+	FreeBuffer *freeLists[RECYCLER_SIZE_CLASSES];
+	size_t retained;	//bytes held in the free lists
+	size_t maxRetained;
+	size_t hitCount;
+	size_t missCount;
+	bool threadLocal;	//the local() instance of a thread
+
+	#if defined(_MSC_FULL_VER) && _MSC_FULL_VER < 180000000
+	BufferRecycler (const BufferRecycler &);
+	BufferRecycler& operator= (const BufferRecycler &);
+	#else
+	BufferRecycler (const BufferRecycler &) = delete;
+	BufferRecycler& operator= (const BufferRecycler &) = delete;
+	#endif
+
+	//smallest class holding 'bytes', RECYCLER_SIZE_CLASSES if there is none
+	static size_t classOf (size_t bytes) noexcept {
+		size_t sizeClass = 0;
+		for (size_t classBytes = RECYCLER_MIN_CLASS_BYTES; classBytes < bytes && sizeClass < RECYCLER_SIZE_CLASSES; classBytes <<= 1) {
+			++sizeClass;
+		}
+		return sizeClass;
+	}
+
+	static size_t classBytes (size_t sizeClass) noexcept {
+		return RECYCLER_MIN_CLASS_BYTES << sizeClass;
+	}
+
+	//set when the local() instance of the calling thread was destroyed; trivial, so it outlives every thread_local object
+	static bool& localDestroyed () noexcept {
+		static thread_local bool destroyed = false;
+		return destroyed;
+	}
+
+	//a new buffer of the size class of 'bytes', so that any recycler may cache it on release
+	static void* allocateClass (size_t bytes) {
+		size_t sizeClass = classOf(bytes);
+		void *ptr = malloc(sizeClass < RECYCLER_SIZE_CLASSES ? classBytes(sizeClass) : bytes);
+		if (!ptr) {
+			VECTOR_THROW(std::bad_alloc());
+		}
+		return ptr;
+	}
+
+	BufferRecycler (size_t limit, bool threadLocal)
+		: retained(0), maxRetained(limit), hitCount(0), missCount(0), threadLocal(threadLocal) {
+		for (size_t i = 0; i < RECYCLER_SIZE_CLASSES; ++i) {
+			freeLists[i] = nullptr;
+		}
+	}
+
+public:
+	explicit BufferRecycler (size_t limit = RECYCLER_DEFAULT_LIMIT) : BufferRecycler (limit, false) { }
+
+	~BufferRecycler () {
+		if (threadLocal) {
+			localDestroyed() = true;
+		}
+		trim();
+	}
+
+	//recycler of the calling thread. Must not be used once it was destroyed at thread exit, see acquireLocal()
+	static BufferRecycler& local () {
+		static thread_local BufferRecycler recycler (RECYCLER_DEFAULT_LIMIT, true);
+		return recycler;
+	}
+
+	//acquire() of the calling thread's recycler, malloc once that recycler was destroyed
+	static void* acquireLocal (size_t bytes) {
+		if (localDestroyed()) {
+			return allocateClass(bytes);
+		}
+		return local().acquire(bytes);
+	}
+
+	//release() to the calling thread's recycler, free once that recycler was destroyed
+	static void releaseLocal (void *ptr, size_t bytes) noexcept {
+		if (localDestroyed()) {
+			free(ptr);
+			return;
+		}
+		local().release(ptr, bytes);
+	}
+
+	//buffer of at least 'bytes' bytes (malloc alignment). Throws std::bad_alloc on failure.
+	void* acquire (size_t bytes) {
+		size_t sizeClass = classOf(bytes);
+		if (sizeClass < RECYCLER_SIZE_CLASSES && freeLists[sizeClass]) {
+			FreeBuffer *buffer = freeLists[sizeClass];
+			freeLists[sizeClass] = buffer->next;
+			retained -= classBytes(sizeClass);
+			++hitCount;
+			return buffer;
+		}
+
+		++missCount;
+		return allocateClass(bytes);
+	}
+
+	//takes back a buffer obtained by acquire(bytes) on any thread
+	void release (void *ptr, size_t bytes) noexcept {
+		if (!ptr) {
+			return;
+		}
+
+		size_t sizeClass = classOf(bytes);
+		if (sizeClass >= RECYCLER_SIZE_CLASSES || retained + classBytes(sizeClass) > maxRetained) {
+			free(ptr);
+			return;
+		}
+
+		FreeBuffer *buffer = static_cast<FreeBuffer*>(ptr);
+		buffer->next = freeLists[sizeClass];
+		freeLists[sizeClass] = buffer;
+		retained += classBytes(sizeClass);
+	}
+
+	//frees every retained buffer
+	void trim () noexcept {
+		for (size_t i = 0; i < RECYCLER_SIZE_CLASSES; ++i) {
+			while (freeLists[i]) {
+				FreeBuffer *next = freeLists[i]->next;
+				free(freeLists[i]);
+				freeLists[i] = next;
+			}
+		}
+		retained = 0;
+	}
+
+	//retained memory bound in bytes; lowering it trims the cache
+	size_t limit () const noexcept { return maxRetained; }
+	void setLimit (size_t limit) noexcept {
+		maxRetained = limit;
+		if (retained > maxRetained) {
+			trim();
+		}
+	}
+
+	size_t bytesRetained () const noexcept { return retained; }
+	size_t hits () const noexcept { return hitCount; }
+	size_t misses () const noexcept { return missCount; }
+
+	//share of acquire calls served from the cache
+	double hitRate () const noexcept {
+		return hitCount + missCount ? static_cast<double>(hitCount) / (hitCount + missCount) : 0;
+	}
+};
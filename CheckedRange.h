@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include "Vector.h"
+
+#if defined(_MSC_FULL_VER) && _MSC_FULL_VER < 180000000
+#define noexcept throw()
+#endif
+
+namespace range_detail {
+	inline void failModified () {
+		VECTOR_THROW(InvalidOperationException ("Vector was reallocated or shrunk during checked traversal"));
+	}
+
+	inline void checkBounds (size_t offset, size_t count, size_t size) {
+		if (offset > size || count > size - offset) {
+			VECTOR_THROW(IndexOutOfRangeException ("Checked range out of range"));
+		}
+	}
+}
+
+template <typename T>
+class CheckedRange;
+
+///<summary>
+///Iterator of CheckedRange: a raw pointer, the generation counter of the vector and its value on entry.
+///Advancing compares the two, so an element is never read after the buffer moved or shrank.
+///</summary>
+template <typename T>
+class CheckedRangeIterator {
+private:
+	T *current;
+	const size_t *stamp;
+	size_t expected;
+
+	friend class CheckedRange<T>;
+
+	CheckedRangeIterator (T *current, const size_t *stamp, size_t expected) noexcept
+		: current(current), stamp(stamp), expected(expected) { }
+
+public:
+	typedef std::forward_iterator_tag iterator_category;
+	typedef typename std::remove_const<T>::type value_type;
+	typedef ptrdiff_t difference_type;
+	typedef T* pointer;
+	typedef T& reference;
+
+	CheckedRangeIterator () noexcept : current(nullptr), stamp(nullptr), expected(0) { }
+
+	T& operator* () const noexcept { return *current; }
+	T* operator-> () const noexcept { return current; }
+
+	CheckedRangeIterator& operator++ () {
+		if (*stamp != expected) {
+			range_detail::failModified();
+		}
+		++current;
+		return *this;
+	}
+
+	CheckedRangeIterator operator++ (int) { CheckedRangeIterator clone(*this); ++*this; return clone; }
+
+	bool operator== (const CheckedRangeIterator &another) const noexcept { return current == another.current; }
+	bool operator!= (const CheckedRangeIterator &another) const noexcept { return current != another.current; }
+};
+
+///<summary>
+///Range of Vector elements for range-for, returned by Vector::checked(). The bounds are validated once,
+///when the range is made; the loop then runs on raw pointers with a single generation comparison per step
+///instead of the container lookups of the checked iterators. Reallocating or shrinking the vector inside
+///the loop throws InvalidOperationException at the next step. Elements appended in the loop are not visited.
+///The vector must outlive the range.
+///</summary>
+template <typename T>
+class CheckedRange {
+private:
+	typedef typename std::remove_const<T>::type ValueType;
+
+	const size_t *stamp;
+	size_t generation;
+	T *first;
+	T *last;
+
+	friend class Vector<ValueType>;
+
+	CheckedRange (const Vector<ValueType> *owner, T *first, T *last) noexcept
+		: stamp(&owner->bufferGeneration), generation(owner->bufferGeneration), first(first), last(last) { }
+
+public:
+	typedef CheckedRangeIterator<T> iterator;
+
+	iterator begin () const noexcept { return iterator (first, stamp, generation); }
+	iterator end () const noexcept { return iterator (last, stamp, generation); }
+
+	size_t size () const noexcept { return static_cast<size_t>(last - first); }
+	bool empty () const noexcept { return first == last; }
+};
+
+#pragma region Vector checked range implementation
+
+template <typename T>
+CheckedRange<T> Vector<T>::checked () {
+	return CheckedRange<T> (this, memory_begin, data_end);
+}
+
+template <typename T>
+CheckedRange<T> Vector<T>::checked (size_t offset, size_t count) {
+	range_detail::checkBounds(offset, count, size());
+	return CheckedRange<T> (this, memory_begin + offset, memory_begin + offset + count);
+}
+
+template <typename T>
+CheckedRange<const T> Vector<T>::checked () const {
+	return CheckedRange<const T> (this, memory_begin, data_end);
+}
+
+template <typename T>
+CheckedRange<const T> Vector<T>::checked (size_t offset, size_t count) const {
+	range_detail::checkBounds(offset, count, size());
+	return CheckedRange<const T> (this, memory_begin + offset, memory_begin + offset + count);
+}
+
+#pragma endregion
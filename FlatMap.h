@@ -0,0 +1,207 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include "Vector.h"
+#include "FlatSearch.h"
+
+#if defined(_MSC_FULL_VER) && _MSC_FULL_VER < 180000000
+#define noexcept throw()
+#endif
+
+struct KeyNotFoundException : public ExceptionWithMessage {
+	explicit KeyNotFoundException (const char* msg) : ExceptionWithMessage(msg) { }
+	KeyNotFoundException () : ExceptionWithMessage ("Key not found") { }
+};
+
+///<summary>
+///Sorted map stored as two parallel Vectors: keys and values.
+///Keys are kept apart from values so that lookups scan densely packed keys only
+///(branchless binary search, SIMD scan for int keys).
+///Single inserts and erases shift the tail: O(n). Batches should go through insert(begin, end).
+///</summary>
+template <typename K, typename V, typename Less = std::less<K>>
+class FlatMap {
+private:
+	Vector<K> keys;
+	Vector<V> values;
+	Less less;
+
+	size_t position (const K &key) const {
+		return flat_detail::lowerBound(keys.data(), keys.size(), key, less);
+	}
+
+	bool equalAt (size_t index, const K &key) const {
+		return index < keys.size() && !less(key, keys.data()[index]);
+	}
+
+	//places (key, value) at 'index', shifting the tails
+	template <typename Value>
+	void insertAt (size_t index, const K &key, Value &&value) {
+		keys.push_back(key);
+		VECTOR_TRY {
+			values.push_back(std::forward<Value>(value));
+		}
+		VECTOR_CATCH_ALL {
+			keys.pop_back();
+			VECTOR_RETHROW;
+		}
+
+		K *firstKey = keys.data();
+		std::rotate(firstKey + index, firstKey + keys.size() - 1, firstKey + keys.size());
+		V *firstValue = values.data();
+		std::rotate(firstValue + index, firstValue + values.size() - 1, firstValue + values.size());
+	}
+
+public:
+	typedef K key_type;
+	typedef V mapped_type;
+
+	FlatMap () { }
+	explicit FlatMap (const Less &less) : less(less) { }
+
+	size_t size () const noexcept { return keys.size(); }
+	bool empty () const noexcept { return keys.empty(); }
+
+	void reserve (size_t capacity) {
+		keys.reserve(capacity);
+		values.reserve(capacity);
+	}
+
+	void clear () noexcept {
+		keys.clear();
+		values.clear();
+	}
+
+	//sorted keys and the values in the same order
+	const Vector<K>& key_data () const noexcept { return keys; }
+	const Vector<V>& value_data () const noexcept { return values; }
+
+	bool contains (const K &key) const {
+		return equalAt(position(key), key);
+	}
+
+	//null if there is no such key
+	V* find (const K &key) {
+		size_t index = position(key);
+		return equalAt(index, key) ? values.data() + index : nullptr;
+	}
+
+	const V* find (const K &key) const {
+		size_t index = position(key);
+		return equalAt(index, key) ? values.data() + index : nullptr;
+	}
+
+	V& at (const K &key) {
+		V *value = find(key);
+		if (!value) {
+			VECTOR_THROW(KeyNotFoundException());
+		}
+		return *value;
+	}
+
+	const V& at (const K &key) const {
+		const V *value = find(key);
+		if (!value) {
+			VECTOR_THROW(KeyNotFoundException());
+		}
+		return *value;
+	}
+
+	//inserts a default-constructed value if there is no such key
+	V& operator[] (const K &key) {
+		size_t index = position(key);
+		if (!equalAt(index, key)) {
+			insertAt(index, key, V());
+		}
+		return values.data()[index];
+	}
+
+	//returns false (and keeps the old value) if the key is already present
+	bool insert (const K &key, const V &value) {
+		size_t index = position(key);
+		if (equalAt(index, key)) {
+			return false;
+		}
+
+		insertAt(index, key, value);
+		return true;
+	}
+
+	bool insert (const K &key, V &&value) {
+		size_t index = position(key);
+		if (equalAt(index, key)) {
+			return false;
+		}
+
+		insertAt(index, key, std::move(value));
+		return true;
+	}
+
+	//Batched insert of std::pair<K, V>-like elements: the batch is sorted (stable) and merged in one pass.
+	//Keys already present are kept, among duplicates of the batch the first one wins.
+	template <typename InputIterator>
+	void insert (InputIterator begin, InputIterator end) {
+		Vector<std::pair<K, V>> batch;
+		for (InputIterator i = begin; i != end; ++i) {
+			batch.push_back(std::pair<K, V>(i->first, i->second));
+		}
+		if (batch.empty()) {
+			return;
+		}
+
+		const Less &compare = less;
+		std::pair<K, V> *batchFirst = batch.data();
+		std::pair<K, V> *batchLast = batchFirst + batch.size();
+		std::stable_sort(batchFirst, batchLast, [&compare](const std::pair<K, V> &a, const std::pair<K, V> &b) {
+			return compare(a.first, b.first);
+		});
+
+		Vector<K> mergedKeys;
+		Vector<V> mergedValues;
+		mergedKeys.reserve(keys.size() + batch.size());
+		mergedValues.reserve(keys.size() + batch.size());
+
+		K *oldKey = keys.data();
+		V *oldValue = values.data();
+		K *oldKeysEnd = oldKey + keys.size();
+
+		for (std::pair<K, V> *i = batchFirst; i < batchLast; ++i) {
+			while (oldKey < oldKeysEnd && less(*oldKey, i->first)) {
+				mergedKeys.push_back(std::move(*oldKey++));
+				mergedValues.push_back(std::move(*oldValue++));
+			}
+
+			bool present = (oldKey < oldKeysEnd && !less(i->first, *oldKey))
+				|| (!mergedKeys.empty() && !less(mergedKeys.data()[mergedKeys.size() - 1], i->first));
+			if (!present) {
+				mergedKeys.push_back(std::move(i->first));
+				mergedValues.push_back(std::move(i->second));
+			}
+		}
+		while (oldKey < oldKeysEnd) {
+			mergedKeys.push_back(std::move(*oldKey++));
+			mergedValues.push_back(std::move(*oldValue++));
+		}
+
+		keys.swap(mergedKeys);
+		values.swap(mergedValues);
+	}
+
+	//returns false if there was no such key
+	bool erase (const K &key) {
+		size_t index = position(key);
+		if (!equalAt(index, key)) {
+			return false;
+		}
+
+		K *firstKey = keys.data();
+		std::move(firstKey + index + 1, firstKey + keys.size(), firstKey + index);
+		keys.pop_back();
+		V *firstValue = values.data();
+		std::move(firstValue + index + 1, firstValue + values.size(), firstValue + index);
+		values.pop_back();
+		return true;
+	}
+};
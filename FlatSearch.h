@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+//Search kernels for sorted contiguous arrays, used by FlatSet and FlatMap.
+
+namespace flat_detail {
+	//ranges of at most this many elements are scanned linearly instead of halved
+	const size_t LINEAR_SCAN_LIMIT = 16;
+
+	//Branchless binary search: the loop has a fixed trip count of log2(n)
+	//and the comparison result only selects the next base (compiles to cmov).
+	template <typename K, typename Less>
+	const K* narrow (const K *base, size_t &n, const K &key, const Less &less) {
+		while (n > LINEAR_SCAN_LIMIT) {
+			size_t half = n / 2;
+			base = less(base[half - 1], key) ? base + half : base;
+			n -= half;
+		}
+		return base;
+	}
+
+	//number of elements of [base, base + n) that are less than key
+	template <typename K, typename Less>
+	size_t countLess (const K *base, size_t n, const K &key, const Less &less) {
+		size_t count = 0;
+		for (size_t i = 0; i < n; ++i) {
+			count += less(base[i], key) ? 1 : 0;
+		}
+		return count;
+	}
+
+	#ifdef __SSE2__
+	//4 keys per instruction
+	inline size_t countLess (const int *base, size_t n, const int &key, const std::less<int> &) {
+		__m128i pattern = _mm_set1_epi32(key);
+		size_t count = 0;
+		size_t i = 0;
+
+		for (; i + 4 <= n; i += 4) {
+			__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(base + i));
+			int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(pattern, block)));
+			count += (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + ((mask >> 3) & 1);
+		}
+		for (; i < n; ++i) {
+			count += base[i] < key ? 1 : 0;
+		}
+
+		return count;
+	}
+	#endif
+
+	//index of the first element of sorted [data, data + n) that is not less than key
+	template <typename K, typename Less>
+	size_t lowerBound (const K *data, size_t n, const K &key, const Less &less) {
+		const K *base = narrow(data, n, key, less);
+		return (base - data) + countLess(base, n, key, less);
+	}
+}
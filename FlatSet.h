@@ -0,0 +1,141 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include "Vector.h"
+#include "FlatSearch.h"
+
+#if defined(_MSC_FULL_VER) && _MSC_FULL_VER < 180000000
+#define noexcept throw()
+#endif
+
+///<summary>
+///Sorted set of unique keys stored contiguously in a Vector.
+///Lookups are branchless binary searches finished by a linear (SIMD for int) scan.
+///Single inserts and erases shift the tail: O(n). Batches should go through insert(begin, end):
+///they are appended, sorted and merged in O(n + m log m).
+///</summary>
+template <typename K, typename Less = std::less<K>>
+class FlatSet {
+private:
+	Vector<K> keys;
+	Less less;
+
+	size_t position (const K &key) const {
+		return flat_detail::lowerBound(keys.data(), keys.size(), key, less);
+	}
+
+	bool equalAt (size_t index, const K &key) const {
+		return index < keys.size() && !less(key, keys.data()[index]);
+	}
+
+public:
+	typedef K value_type;
+	typedef typename Vector<K>::const_iterator iterator;
+	typedef typename Vector<K>::const_iterator const_iterator;
+
+	FlatSet () { }
+	explicit FlatSet (const Less &less) : less(less) { }
+
+	template <typename InputIterator>
+	FlatSet (InputIterator begin, InputIterator end) {
+		insert(begin, end);
+	}
+
+	size_t size () const noexcept { return keys.size(); }
+	bool empty () const noexcept { return keys.empty(); }
+	void reserve (size_t capacity) { keys.reserve(capacity); }
+	void clear () noexcept { keys.clear(); }
+
+	//sorted keys
+	const Vector<K>& data () const noexcept { return keys; }
+	const K& operator[] (size_t index) const { return keys[index]; }
+
+	const_iterator begin () const { return keys.cbegin(); }
+	const_iterator end () const { return keys.cend(); }
+
+	const_iterator lower_bound (const K &key) const {
+		return keys.cbegin() + position(key);
+	}
+
+	const_iterator find (const K &key) const {
+		size_t index = position(key);
+		return equalAt(index, key) ? keys.cbegin() + index : keys.cend();
+	}
+
+	bool contains (const K &key) const {
+		return equalAt(position(key), key);
+	}
+
+	size_t count (const K &key) const {
+		return contains(key) ? 1 : 0;
+	}
+
+	//returns false if the key is already present
+	bool insert (const K &key) {
+		size_t index = position(key);
+		if (equalAt(index, key)) {
+			return false;
+		}
+
+		keys.push_back(key);
+		K *first = keys.data();
+		std::rotate(first + index, first + keys.size() - 1, first + keys.size());
+		return true;
+	}
+
+	//batched insert: append, sort the batch, merge. Keys already present are kept.
+	//If copying or sorting the batch throws, the set is unchanged; if the merge throws, the set is left empty.
+	template <typename InputIterator>
+	void insert (InputIterator begin, InputIterator end) {
+		size_t oldSize = keys.size();
+
+		VECTOR_TRY {
+			for (InputIterator i = begin; i != end; ++i) {
+				keys.push_back(*i);
+			}
+			std::stable_sort(keys.data() + oldSize, keys.data() + keys.size(), less);
+		}
+		VECTOR_CATCH_ALL {
+			keys.truncate(oldSize);
+			VECTOR_RETHROW;
+		}
+
+		K *first = keys.data();
+		K *middle = first + oldSize;
+		K *last = first + keys.size();
+		if (middle == last) {
+			return;
+		}
+
+		const Less &compare = less;
+		K *uniqueEnd = last;
+		VECTOR_TRY {
+			std::inplace_merge(first, middle, last, less);
+			uniqueEnd = std::unique(first, last, [&compare](const K &a, const K &b) { return !compare(a, b); });
+		}
+		VECTOR_CATCH_ALL {
+			//the old keys may already be interleaved with the batch: no sorted state to go back to
+			keys.clear(true);
+			VECTOR_RETHROW;
+		}
+		keys.truncate(static_cast<size_t>(uniqueEnd - first));
+	}
+
+	//returns false if there was no such key
+	bool erase (const K &key) {
+		size_t index = position(key);
+		if (!equalAt(index, key)) {
+			return false;
+		}
+
+		K *first = keys.data();
+		std::move(first + index + 1, first + keys.size(), first + index);
+		keys.pop_back();
+		return true;
+	}
+
+	bool operator== (const FlatSet<K, Less> &other) const { return keys == other.keys; }
+	bool operator!= (const FlatSet<K, Less> &other) const { return !(*this == other); }
+};
@@ -4,6 +4,9 @@
 #include <stdexcept>
 #include <typeinfo>
 #include <cstddef>
+#include <memory>
+#include <type_traits>
+#include "VectorConfig.h"
 #include "Vector.h"
 
 #ifdef MEMORY_TRACE_MODE
@@ -24,6 +27,9 @@ class Vector;
 template <typename T, typename IteratorImpl, typename V>
 class BaseIterator;
 
+template <typename T>
+class VectorView;
+
 #pragma region exceptions
 
 struct ExceptionWithMessage : public std::exception {
@@ -87,17 +93,27 @@ private:
 	template <typename T>
 	friend class ConstIterator;
 
+	template <typename T>
+	friend class RingVector;
+
+	template <typename T>
+	friend class RingIterator;
+
+	template <typename T, size_t N, typename OverflowPolicy>
+	friend class StaticVector;
+
 	IteratorImpl *headIterator;
 	V *vector;
 
-	void addIterator (IteratorImpl *iter);
-	void invalidateAll ();
+	VECTOR_CONSTEXPR void addIterator (IteratorImpl *iter);
+	VECTOR_CONSTEXPR void invalidateAll ();
+	void detachAll (); //for containers that are not on the heap: iterators forget the container
 
 	//is vector already destroyed
-	bool isVectorDestroyed () { return !vector; }
+	VECTOR_CONSTEXPR bool isVectorDestroyed () { return !vector; }
 
 public:
-	explicit IteratorContainer (V *host) {
+	VECTOR_CONSTEXPR explicit IteratorContainer (V *host) {
 		headIterator = nullptr;
 		vector = host;
 
@@ -110,7 +126,7 @@ public:
 		#endif
 	}
 
-	~IteratorContainer () {
+	VECTOR_CONSTEXPR ~IteratorContainer () {
 		#ifdef DEBUG_MODE
 		std::cerr << "~IteratorContainer<" << typeid(IteratorImpl).name() << ">()" << std::endl;
 		#endif
@@ -128,12 +144,13 @@ template <typename T>
 class ConstIterator;
 
 template <typename T, typename IteratorImpl, typename V>
-IteratorImpl operator+ (ptrdiff_t offset, const BaseIterator<T, IteratorImpl, V> &iter);
+VECTOR_CONSTEXPR IteratorImpl operator+ (ptrdiff_t offset, const BaseIterator<T, IteratorImpl, V> &iter);
 
 //Base class for const and non-const iterator.
 //When created within a real vector, registers itself at IteratorContainer.
+//Vector storage is contiguous: in C++20 iterators model std::contiguous_iterator.
 template <typename T, typename IteratorImpl, typename V>
-class BaseIterator : public std::iterator<std::random_access_iterator_tag, T> {
+class BaseIterator {
 private:
 	T *ptr; //ptr inside the vector
 	IteratorContainer<IteratorImpl, V> *container; //all iterators of this type bound to the same vector
@@ -145,96 +162,111 @@ private:
 	template <typename T2, typename IteratorImpl2, typename V2>
 	friend class BaseIterator;
 
-	IteratorImpl* that() {
+	template <typename T2>
+	friend class VectorView;
+
+	VECTOR_CONSTEXPR IteratorImpl* that() {
 		return static_cast<IteratorImpl*>(this);
 	}
 
-	const IteratorImpl* that () const {
+	VECTOR_CONSTEXPR const IteratorImpl* that () const {
 		return static_cast<const IteratorImpl*>(this);
 	}
 
 	//check if this and another are bound to the same vector
 	//Attention: this->container and another->container must exist!
 	template <typename T2, typename IteratorImpl2>
-	void checkDomainEquality (const BaseIterator<T2, IteratorImpl2, V> &another) const {
+	VECTOR_CONSTEXPR void checkDomainEquality (const BaseIterator<T2, IteratorImpl2, V> &another) const {
 		if (container->vector != another.container->vector) {
-			throw DifferentIteratorDomainException();
+			VECTOR_THROW(DifferentIteratorDomainException());
 		}
 	}
 
-	void selfRemoveFromContainer ();
+	VECTOR_CONSTEXPR void selfRemoveFromContainer ();
 
 protected:
-	T* dataPointer () const { return ptr; }
-	IteratorContainer<IteratorImpl, V>* iterContainer () const { return container; }
+	VECTOR_CONSTEXPR T* dataPointer () const { return ptr; }
+	VECTOR_CONSTEXPR IteratorContainer<IteratorImpl, V>* iterContainer () const { return container; }
 
-	bool isValid () const {
+	VECTOR_CONSTEXPR bool isValid () const {
 		return container && container->vector;
 	}
 
 	//check if our ptr is valid. Throws exception if not valid.
-	void checkValidity () const {
+	VECTOR_CONSTEXPR void checkValidity () const {
 		if (!isValid()) {
-			throw InvalidIteratorException();
+			VECTOR_THROW(InvalidIteratorException());
 		}
 	}
 
-	BaseIterator (T *ptr, IteratorContainer<IteratorImpl, V> *container);
+	VECTOR_CONSTEXPR BaseIterator (T *ptr, IteratorContainer<IteratorImpl, V> *container);
 
 public:
-	BaseIterator ();
-	BaseIterator (const BaseIterator<T, IteratorImpl, V> &iter);
+	typedef std::random_access_iterator_tag iterator_category;
+	#ifdef VECTOR_CXX20
+	typedef std::contiguous_iterator_tag iterator_concept;
+	#endif
+	typedef typename std::remove_const<T>::type value_type;
+	typedef ptrdiff_t difference_type;
+	typedef T* pointer;
+	typedef T& reference;
+
+	VECTOR_CONSTEXPR BaseIterator ();
+	VECTOR_CONSTEXPR BaseIterator (const BaseIterator<T, IteratorImpl, V> &iter);
 
-	~BaseIterator ();
+	VECTOR_CONSTEXPR ~BaseIterator ();
 
-	IteratorImpl& operator= (const BaseIterator<T, IteratorImpl, V> &iter);
+	VECTOR_CONSTEXPR IteratorImpl& operator= (const BaseIterator<T, IteratorImpl, V> &iter);
 
 	template <typename T2, typename IteratorImpl2>
-	bool operator== (const BaseIterator<T2, IteratorImpl2, V> &iter) const;
+	VECTOR_CONSTEXPR bool operator== (const BaseIterator<T2, IteratorImpl2, V> &iter) const;
 
 	template <typename T2, typename IteratorImpl2>
-	bool operator!= (const BaseIterator<T2, IteratorImpl2, V> &iter) const;
+	VECTOR_CONSTEXPR bool operator!= (const BaseIterator<T2, IteratorImpl2, V> &iter) const;
 
-	T& operator* () const;
-	T* operator-> () const;
+	VECTOR_CONSTEXPR T& operator* () const;
+	VECTOR_CONSTEXPR T* operator-> () const;
 
-	IteratorImpl& operator++ ();
-	IteratorImpl operator++ (int);
+	//raw pointer this iterator refers to (end() included). Only checks validity.
+	VECTOR_CONSTEXPR T* address () const;
 
-	IteratorImpl& operator-- ();
-	IteratorImpl operator-- (int);
+	VECTOR_CONSTEXPR IteratorImpl& operator++ ();
+	VECTOR_CONSTEXPR IteratorImpl operator++ (int);
 
-	IteratorImpl operator+ (ptrdiff_t offset) const;
-	IteratorImpl operator- (ptrdiff_t offset) const;
+	VECTOR_CONSTEXPR IteratorImpl& operator-- ();
+	VECTOR_CONSTEXPR IteratorImpl operator-- (int);
+
+	VECTOR_CONSTEXPR IteratorImpl operator+ (ptrdiff_t offset) const;
+	VECTOR_CONSTEXPR IteratorImpl operator- (ptrdiff_t offset) const;
 
 	template <typename T2, typename IteratorImpl2>
-	ptrdiff_t operator- (const BaseIterator<T2, IteratorImpl2, V> &another) const;
+	VECTOR_CONSTEXPR ptrdiff_t operator- (const BaseIterator<T2, IteratorImpl2, V> &another) const;
 
 	template <typename T2, typename IteratorImpl2>
-	bool operator< (const BaseIterator<T2, IteratorImpl2, V> &another) const;
+	VECTOR_CONSTEXPR bool operator< (const BaseIterator<T2, IteratorImpl2, V> &another) const;
 
 	template <typename T2, typename IteratorImpl2>
-	bool operator<= (const BaseIterator<T2, IteratorImpl2, V> &another) const;
+	VECTOR_CONSTEXPR bool operator<= (const BaseIterator<T2, IteratorImpl2, V> &another) const;
 
 	template <typename T2, typename IteratorImpl2>
-	bool operator> (const BaseIterator<T2, IteratorImpl2, V> &another) const;
+	VECTOR_CONSTEXPR bool operator> (const BaseIterator<T2, IteratorImpl2, V> &another) const;
 
 	template <typename T2, typename IteratorImpl2>
-	bool operator>= (const BaseIterator<T2, IteratorImpl2, V> &another) const;
+	VECTOR_CONSTEXPR bool operator>= (const BaseIterator<T2, IteratorImpl2, V> &another) const;
 
-	IteratorImpl& operator+= (ptrdiff_t offset);
-	IteratorImpl& operator-= (ptrdiff_t offset);
+	VECTOR_CONSTEXPR IteratorImpl& operator+= (ptrdiff_t offset);
+	VECTOR_CONSTEXPR IteratorImpl& operator-= (ptrdiff_t offset);
 
-	T& operator[] (ptrdiff_t offset) const;
+	VECTOR_CONSTEXPR T& operator[] (ptrdiff_t offset) const;
 
 	template <typename T2, typename IteratorImpl2, typename V2>
-	friend IteratorImpl2 operator+ (ptrdiff_t offset, const BaseIterator<T2, IteratorImpl2, V2> &iter);
+	friend VECTOR_CONSTEXPR IteratorImpl2 operator+ (ptrdiff_t offset, const BaseIterator<T2, IteratorImpl2, V2> &iter);
 };
 
 #pragma region IteratorContainer implementation
 
 template <typename IteratorImpl, typename V>
-void IteratorContainer<IteratorImpl, V>::invalidateAll () {
+VECTOR_CONSTEXPR void IteratorContainer<IteratorImpl, V>::invalidateAll () {
 	vector = nullptr;
 
 	if (!headIterator) {
@@ -243,7 +275,13 @@ void IteratorContainer<IteratorImpl, V>::invalidateAll () {
 }
 
 template <typename IteratorImpl, typename V>
-void IteratorContainer<IteratorImpl, V>::addIterator (IteratorImpl *iter) {
+VECTOR_CONSTEXPR void IteratorContainer<IteratorImpl, V>::addIterator (IteratorImpl *iter) {
+	//Constant evaluation: iterators are not chained, the container only tells if the vector is alive.
+	//Using an iterator after reallocation touches a freed container, which the compiler rejects.
+	if (VECTOR_CONSTANT_EVALUATED()) {
+		return;
+	}
+
 	//iter becomes the head
 
 	if (!headIterator) { //no chain presenter
@@ -259,12 +297,25 @@ void IteratorContainer<IteratorImpl, V>::addIterator (IteratorImpl *iter) {
 	}
 }
 
+template <typename IteratorImpl, typename V>
+void IteratorContainer<IteratorImpl, V>::detachAll () {
+	for (IteratorImpl *iter = headIterator; iter; ) {
+		IteratorImpl *next = iter->next;
+		iter->container = nullptr;
+		iter->next = iter->prev = nullptr;
+		iter = next;
+	}
+
+	headIterator = nullptr;
+	vector = nullptr;
+}
+
 #pragma endregion
 
 #pragma region BaseIterator implementation
 
 template <typename T, typename IteratorImpl, typename V>
-BaseIterator<T, IteratorImpl, V>::BaseIterator (T* ptr, IteratorContainer<IteratorImpl, V>* container) {
+VECTOR_CONSTEXPR BaseIterator<T, IteratorImpl, V>::BaseIterator (T* ptr, IteratorContainer<IteratorImpl, V>* container) {
 	#ifdef DEBUG_MODE
 	std::cerr << typeid(*that()).name() << "(T*, Container*)" << std::endl;
 	#endif
@@ -280,7 +331,7 @@ BaseIterator<T, IteratorImpl, V>::BaseIterator (T* ptr, IteratorContainer<Iterat
 }
 
 template <typename T, typename IteratorImpl, typename V>
-BaseIterator<T, IteratorImpl, V>::BaseIterator () {
+VECTOR_CONSTEXPR BaseIterator<T, IteratorImpl, V>::BaseIterator () {
 	#ifdef DEBUG_MODE
 	std::cerr << typeid(*that()).name() << "()" << std::endl;
 	#endif
@@ -295,7 +346,7 @@ BaseIterator<T, IteratorImpl, V>::BaseIterator () {
 }
 
 template <typename T, typename IteratorImpl, typename V>
-BaseIterator<T, IteratorImpl, V>::BaseIterator (const BaseIterator<T, IteratorImpl, V> &iter) {
+VECTOR_CONSTEXPR BaseIterator<T, IteratorImpl, V>::BaseIterator (const BaseIterator<T, IteratorImpl, V> &iter) {
 	#ifdef DEBUG_MODE
 	std::cerr << typeid(*that()).name() << "(const &)" << std::endl;
 	#endif
@@ -313,7 +364,7 @@ BaseIterator<T, IteratorImpl, V>::BaseIterator (const BaseIterator<T, IteratorIm
 }
 
 template <typename T, typename IteratorImpl, typename V>
-BaseIterator<T, IteratorImpl, V>::~BaseIterator () {
+VECTOR_CONSTEXPR BaseIterator<T, IteratorImpl, V>::~BaseIterator () {
 	#ifdef DEBUG_MODE
 	std::cerr << "~" << typeid(*that()).name() << "()" << std::endl;
 	#endif
@@ -326,7 +377,12 @@ BaseIterator<T, IteratorImpl, V>::~BaseIterator () {
 }
 
 template <typename T, typename IteratorImpl, typename V>
-void BaseIterator<T, IteratorImpl, V>::selfRemoveFromContainer () {
+VECTOR_CONSTEXPR void BaseIterator<T, IteratorImpl, V>::selfRemoveFromContainer () {
+	if (VECTOR_CONSTANT_EVALUATED()) { //not chained, see IteratorContainer::addIterator
+		container = nullptr;
+		return;
+	}
+
 	//fixing neighbours' links
 	if (prev) {
 		prev->next = next;
@@ -350,7 +406,7 @@ void BaseIterator<T, IteratorImpl, V>::selfRemoveFromContainer () {
 }
 
 template <typename T, typename IteratorImpl, typename V>
-inline IteratorImpl& BaseIterator<T, IteratorImpl, V>::operator= (const BaseIterator<T, IteratorImpl, V> &iter) {
+VECTOR_CONSTEXPR inline IteratorImpl& BaseIterator<T, IteratorImpl, V>::operator= (const BaseIterator<T, IteratorImpl, V> &iter) {
 	ptr = iter.ptr;
 
 	if (container != iter.container) {
@@ -369,7 +425,7 @@ inline IteratorImpl& BaseIterator<T, IteratorImpl, V>::operator= (const BaseIter
 
 template <typename T, typename IteratorImpl, typename V>
 template <typename T2, typename IteratorImpl2>
-bool BaseIterator<T, IteratorImpl, V>::operator== (const BaseIterator<T2, IteratorImpl2, V> &iter) const {
+VECTOR_CONSTEXPR bool BaseIterator<T, IteratorImpl, V>::operator== (const BaseIterator<T2, IteratorImpl2, V> &iter) const {
 	checkValidity();
 	iter.checkValidity();
 	checkDomainEquality(iter);
@@ -379,41 +435,47 @@ bool BaseIterator<T, IteratorImpl, V>::operator== (const BaseIterator<T2, Iterat
 
 template <typename T, typename IteratorImpl, typename V>
 template <typename T2, typename IteratorImpl2>
-inline bool BaseIterator<T, IteratorImpl, V>::operator!= (const BaseIterator<T2, IteratorImpl2, V> &iter) const {
+VECTOR_CONSTEXPR inline bool BaseIterator<T, IteratorImpl, V>::operator!= (const BaseIterator<T2, IteratorImpl2, V> &iter) const {
 	return !operator==(iter);
 }
 
 template <typename T, typename IteratorImpl, typename V>
-T& BaseIterator<T, IteratorImpl, V>::operator* () const {
+VECTOR_CONSTEXPR T& BaseIterator<T, IteratorImpl, V>::operator* () const {
 	return (*this)[0];
 }
 
 template <typename T, typename IteratorImpl, typename V>
-T* BaseIterator<T, IteratorImpl, V>::operator-> () const {
+VECTOR_CONSTEXPR T* BaseIterator<T, IteratorImpl, V>::operator-> () const {
 	checkValidity();
 
 	if (ptr < container->vector->getDataEnd()) {
 		return ptr;
 	}
 	else {
-		throw IteratorOutOfRangeException();
+		VECTOR_THROW(IteratorOutOfRangeException());
 	}
 }
 
 template <typename T, typename IteratorImpl, typename V>
-IteratorImpl& BaseIterator<T, IteratorImpl, V>::operator++ () {
+VECTOR_CONSTEXPR inline T* BaseIterator<T, IteratorImpl, V>::address () const {
+	checkValidity();
+	return ptr;
+}
+
+template <typename T, typename IteratorImpl, typename V>
+VECTOR_CONSTEXPR IteratorImpl& BaseIterator<T, IteratorImpl, V>::operator++ () {
 	checkValidity();
 	if (ptr < container->vector->getDataEnd()) {
 		++ptr;
 		return *that();
 	}
 	else {
-		throw InvalidIteratorShiftException();
+		VECTOR_THROW(InvalidIteratorShiftException());
 	}
 }
 
 template <typename T, typename IteratorImpl, typename V>
-IteratorImpl BaseIterator<T, IteratorImpl, V>::operator++ (int) {
+VECTOR_CONSTEXPR IteratorImpl BaseIterator<T, IteratorImpl, V>::operator++ (int) {
 	IteratorImpl clone(*that());
 
 	++*this;
@@ -422,19 +484,19 @@ IteratorImpl BaseIterator<T, IteratorImpl, V>::operator++ (int) {
 }
 
 template <typename T, typename IteratorImpl, typename V>
-IteratorImpl& BaseIterator<T, IteratorImpl, V>::operator-- () {
+VECTOR_CONSTEXPR IteratorImpl& BaseIterator<T, IteratorImpl, V>::operator-- () {
 	checkValidity();
 	if (ptr > container->vector->getDataBegin()) {
 		--ptr;
 		return *that();
 	}
 	else {
-		throw InvalidIteratorShiftException();
+		VECTOR_THROW(InvalidIteratorShiftException());
 	}
 }
 
 template <typename T, typename IteratorImpl, typename V>
-IteratorImpl BaseIterator<T, IteratorImpl, V>::operator-- (int) {
+VECTOR_CONSTEXPR IteratorImpl BaseIterator<T, IteratorImpl, V>::operator-- (int) {
 	IteratorImpl clone(*that());
 
 	--*this;
@@ -443,20 +505,20 @@ IteratorImpl BaseIterator<T, IteratorImpl, V>::operator-- (int) {
 }
 
 template <typename T, typename IteratorImpl, typename V>
-inline IteratorImpl BaseIterator<T, IteratorImpl, V>::operator+ (ptrdiff_t offset) const {
+VECTOR_CONSTEXPR inline IteratorImpl BaseIterator<T, IteratorImpl, V>::operator+ (ptrdiff_t offset) const {
 	IteratorImpl iter(*that());
 	iter += offset;
 	return iter;
 }
 
 template <typename T, typename IteratorImpl, typename V>
-inline IteratorImpl BaseIterator<T, IteratorImpl, V>::operator- (ptrdiff_t offset) const {
+VECTOR_CONSTEXPR inline IteratorImpl BaseIterator<T, IteratorImpl, V>::operator- (ptrdiff_t offset) const {
 	return *this + (-offset);
 }
 
 template <typename T, typename IteratorImpl, typename V>
 template <typename T2, typename IteratorImpl2>
-ptrdiff_t BaseIterator<T, IteratorImpl, V>::operator- (const BaseIterator<T2, IteratorImpl2, V> &another) const {
+VECTOR_CONSTEXPR ptrdiff_t BaseIterator<T, IteratorImpl, V>::operator- (const BaseIterator<T2, IteratorImpl2, V> &another) const {
 	checkValidity();
 	another.checkValidity();
 	checkDomainEquality (another);
@@ -466,7 +528,7 @@ ptrdiff_t BaseIterator<T, IteratorImpl, V>::operator- (const BaseIterator<T2, It
 
 template <typename T, typename IteratorImpl, typename V>
 template <typename T2, typename IteratorImpl2>
-bool BaseIterator<T, IteratorImpl, V>::operator< (const BaseIterator<T2, IteratorImpl2, V> &another) const {
+VECTOR_CONSTEXPR bool BaseIterator<T, IteratorImpl, V>::operator< (const BaseIterator<T2, IteratorImpl2, V> &another) const {
 	checkValidity();
 	another.checkValidity();
 	checkDomainEquality (another);
@@ -476,24 +538,24 @@ bool BaseIterator<T, IteratorImpl, V>::operator< (const BaseIterator<T2, Iterato
 
 template <typename T, typename IteratorImpl, typename V>
 template <typename T2, typename IteratorImpl2>
-inline bool BaseIterator<T, IteratorImpl, V>::operator<= (const BaseIterator<T2, IteratorImpl2, V> &another) const {
+VECTOR_CONSTEXPR inline bool BaseIterator<T, IteratorImpl, V>::operator<= (const BaseIterator<T2, IteratorImpl2, V> &another) const {
 	return !(another < *that());
 }
 
 template <typename T, typename IteratorImpl, typename V>
 template <typename T2, typename IteratorImpl2>
-inline bool BaseIterator<T, IteratorImpl, V>::operator> (const BaseIterator<T2, IteratorImpl2, V> &another) const {
+VECTOR_CONSTEXPR inline bool BaseIterator<T, IteratorImpl, V>::operator> (const BaseIterator<T2, IteratorImpl2, V> &another) const {
 	return another < *that();
 }
 
 template <typename T, typename IteratorImpl, typename V>
 template <typename T2, typename IteratorImpl2>
-inline bool BaseIterator<T, IteratorImpl, V>::operator>= (const BaseIterator<T2, IteratorImpl2, V> &another) const {
+VECTOR_CONSTEXPR inline bool BaseIterator<T, IteratorImpl, V>::operator>= (const BaseIterator<T2, IteratorImpl2, V> &another) const {
 	return !(*that() < another);
 }
 
 template <typename T, typename IteratorImpl, typename V>
-IteratorImpl& BaseIterator<T, IteratorImpl, V>::operator+= (ptrdiff_t offset) {
+VECTOR_CONSTEXPR IteratorImpl& BaseIterator<T, IteratorImpl, V>::operator+= (ptrdiff_t offset) {
 	checkValidity();
 	if (offset >= 0 ? ((container->vector->getDataEnd() - ptr) >= offset)
 					: ((ptr - container->vector->getDataBegin()) >= -offset)) {
@@ -501,17 +563,17 @@ IteratorImpl& BaseIterator<T, IteratorImpl, V>::operator+= (ptrdiff_t offset) {
 		return *that();
 	}
 	else {
-		throw InvalidIteratorShiftException();
+		VECTOR_THROW(InvalidIteratorShiftException());
 	}
 }
 
 template <typename T, typename IteratorImpl, typename V>
-inline IteratorImpl& BaseIterator<T, IteratorImpl, V>::operator-= (ptrdiff_t offset) {
+VECTOR_CONSTEXPR inline IteratorImpl& BaseIterator<T, IteratorImpl, V>::operator-= (ptrdiff_t offset) {
 	return *this += (-offset);
 }
 
 template <typename T, typename IteratorImpl, typename V>
-inline T& BaseIterator<T, IteratorImpl, V>::operator[] (ptrdiff_t offset) const {
+VECTOR_CONSTEXPR inline T& BaseIterator<T, IteratorImpl, V>::operator[] (ptrdiff_t offset) const {
 	checkValidity();
 
 	if (offset >= 0 ? ((container->vector->getDataEnd() - ptr) > offset)
@@ -520,16 +582,16 @@ inline T& BaseIterator<T, IteratorImpl, V>::operator[] (ptrdiff_t offset) const
 	}
 	else {
 		if ((container->vector->getDataEnd() - ptr) == offset) { //iterator pointers to the end
-			throw IteratorOutOfRangeException();
+			VECTOR_THROW(IteratorOutOfRangeException());
 		}
 		else { //shifting by given offset leads away from range
-			throw InvalidIteratorShiftException();
+			VECTOR_THROW(InvalidIteratorShiftException());
 		}
 	}
 }
 
 template <typename T, typename IteratorImpl, typename V>
-IteratorImpl operator+ (ptrdiff_t offset, const BaseIterator<T, IteratorImpl, V> &iter) {
+VECTOR_CONSTEXPR IteratorImpl operator+ (ptrdiff_t offset, const BaseIterator<T, IteratorImpl, V> &iter) {
 	return iter + offset;
 }
 
@@ -546,14 +608,14 @@ private:
 	friend class Vector<T>;
 	friend class Iterator<T>;
 
-	ConstIterator (T* ptr, IteratorContainer<ConstIterator<T>, Vector<T>> *container)
+	VECTOR_CONSTEXPR ConstIterator (T* ptr, IteratorContainer<ConstIterator<T>, Vector<T>> *container)
 		: BaseIterator<const T, ConstIterator<T>, Vector<T>>(ptr, container) { }
 
 public:
-	ConstIterator (const Iterator<T> &iter) : BaseIterator<const T, ConstIterator<T>, Vector<T>> (iter) { }
+	VECTOR_CONSTEXPR ConstIterator (const Iterator<T> &iter) : BaseIterator<const T, ConstIterator<T>, Vector<T>> (iter) { }
 
-	ConstIterator () { }
-	ConstIterator (const BaseIterator<const T, ConstIterator, Vector<T>> &iter) : BaseIterator<const T, ConstIterator<T>, Vector<T>>(iter) { }
+	VECTOR_CONSTEXPR ConstIterator () { }
+	VECTOR_CONSTEXPR ConstIterator (const BaseIterator<const T, ConstIterator, Vector<T>> &iter) : BaseIterator<const T, ConstIterator<T>, Vector<T>>(iter) { }
 };
 
 template <typename T>
@@ -562,12 +624,12 @@ private:
 	friend class ConstIterator<T>;
 	friend class Vector<T>;
 
-	Iterator (T *ptr, IteratorContainer<Iterator<T>, Vector<T>> *container) : BaseIterator<T, Iterator<T>, Vector<T>> (ptr, container) { }
+	VECTOR_CONSTEXPR Iterator (T *ptr, IteratorContainer<Iterator<T>, Vector<T>> *container) : BaseIterator<T, Iterator<T>, Vector<T>> (ptr, container) { }
 public:
-	Iterator () { }
-	Iterator (const BaseIterator<T, Iterator, Vector<T>> &iter) : BaseIterator<T, Iterator<T>, Vector<T>>(iter) { }
+	VECTOR_CONSTEXPR Iterator () { }
+	VECTOR_CONSTEXPR Iterator (const BaseIterator<T, Iterator, Vector<T>> &iter) : BaseIterator<T, Iterator<T>, Vector<T>>(iter) { }
 
-	operator BaseIterator<const T, ConstIterator<T>, Vector<T>> () const {
+	VECTOR_CONSTEXPR operator BaseIterator<const T, ConstIterator<T>, Vector<T>> () const {
 		if (this->isValid()) {
 			return ConstIterator<T>(this->dataPointer(), this->iterContainer()->vector->constIteratorContainer);
 		}
@@ -576,3 +638,24 @@ public:
 		}
 	}
 };
+
+//std::to_address support: contiguous iterators must be convertible to raw pointers, end() included
+namespace std {
+	template <typename T>
+	struct pointer_traits<Iterator<T>> {
+		typedef Iterator<T> pointer;
+		typedef T element_type;
+		typedef ptrdiff_t difference_type;
+
+		static T* to_address (const Iterator<T> &iter) { return iter.address(); }
+	};
+
+	template <typename T>
+	struct pointer_traits<ConstIterator<T>> {
+		typedef ConstIterator<T> pointer;
+		typedef const T element_type;
+		typedef ptrdiff_t difference_type;
+
+		static const T* to_address (const ConstIterator<T> &iter) { return iter.address(); }
+	};
+}
@@ -2,6 +2,7 @@
 
 #include <cstddef>
 #include <exception>
+#include "VectorConfig.h"
 
 #if defined(_MSC_FULL_VER) && _MSC_FULL_VER < 180000000
 #define noexcept throw()
@@ -28,6 +29,7 @@ private:
 
 	ptrdiff_t memoryAllocated;	//allocated memory. Measured with std::distance
 	ptrdiff_t memoryDeallocated; //deallocated memory. Measured the same way.
+	int storageAllocations;	//buffers obtained from allocateStorage/reallocateStorage, whatever the container
 
 	int baseIteratorsPtrCreated; //created with private 'pointer' constructor
 	int baseIteratorsDefCreated;
@@ -47,6 +49,7 @@ public:
 
 	int getMemoryAllocated () const noexcept { return memoryAllocated; }
 	int getMemoryDeallocated () const noexcept { return memoryDeallocated; }
+	int getStorageAllocations () const noexcept { return storageAllocations; }
 
 	int getBaseIteratorsDefCreated () const noexcept { return baseIteratorsDefCreated; }
 	int getBaseIteratorsCopyCreated () const noexcept { return baseIteratorsCopyCreated; }
@@ -93,23 +96,25 @@ public:
 		checkContainerConsistency ();
 	}
 
-	void onVectorDefCreated () noexcept { ++vectorsDefCreated; }
-	void onVectorCopyCreated () noexcept { ++vectorsCopyCreated; }
-	void onVectorMoveCreated () noexcept { ++vectorsMoveCreated; }
-	void onVectorIterCreated () noexcept { ++vectorsIterCreated; }
-	void onVectorDestroyed () noexcept { ++vectorsDestroyed; }
-
-	void onMemoryAllocated (ptrdiff_t memory) noexcept { memoryAllocated += memory; }
-	void onMemoryDeallocated (ptrdiff_t memory) noexcept { memoryDeallocated += memory; }
-
-	void onBaseIteratorDefCreated () noexcept { ++baseIteratorsDefCreated; }
-	void onBaseIteratorCopyCreated () noexcept { ++baseIteratorsCopyCreated; }
-	void onBaseIteratorMoveCreated () noexcept { ++baseIteratorsMoveCreated; }
-	void onBaseIteratorPtrCreated () noexcept { ++baseIteratorsPtrCreated; }
-	void onBaseIteratorDestroyed () noexcept { ++baseIteratorsDestroyed; }
-
-	void onContainerHostCreated () noexcept { ++containersHostCreated; }
-	void onContainerDestroyed () noexcept { ++containersDestroyed; }
+	//the hooks do nothing during constant evaluation: the watcher is a runtime object
+	VECTOR_CONSTEXPR void onVectorDefCreated () noexcept { if (!VECTOR_CONSTANT_EVALUATED()) { ++vectorsDefCreated; } }
+	VECTOR_CONSTEXPR void onVectorCopyCreated () noexcept { if (!VECTOR_CONSTANT_EVALUATED()) { ++vectorsCopyCreated; } }
+	VECTOR_CONSTEXPR void onVectorMoveCreated () noexcept { if (!VECTOR_CONSTANT_EVALUATED()) { ++vectorsMoveCreated; } }
+	VECTOR_CONSTEXPR void onVectorIterCreated () noexcept { if (!VECTOR_CONSTANT_EVALUATED()) { ++vectorsIterCreated; } }
+	VECTOR_CONSTEXPR void onVectorDestroyed () noexcept { if (!VECTOR_CONSTANT_EVALUATED()) { ++vectorsDestroyed; } }
+
+	VECTOR_CONSTEXPR void onMemoryAllocated (ptrdiff_t memory) noexcept { if (!VECTOR_CONSTANT_EVALUATED()) { memoryAllocated += memory; } }
+	VECTOR_CONSTEXPR void onMemoryDeallocated (ptrdiff_t memory) noexcept { if (!VECTOR_CONSTANT_EVALUATED()) { memoryDeallocated += memory; } }
+	void onStorageAllocated () noexcept { ++storageAllocations; }
+
+	VECTOR_CONSTEXPR void onBaseIteratorDefCreated () noexcept { if (!VECTOR_CONSTANT_EVALUATED()) { ++baseIteratorsDefCreated; } }
+	VECTOR_CONSTEXPR void onBaseIteratorCopyCreated () noexcept { if (!VECTOR_CONSTANT_EVALUATED()) { ++baseIteratorsCopyCreated; } }
+	VECTOR_CONSTEXPR void onBaseIteratorMoveCreated () noexcept { if (!VECTOR_CONSTANT_EVALUATED()) { ++baseIteratorsMoveCreated; } }
+	VECTOR_CONSTEXPR void onBaseIteratorPtrCreated () noexcept { if (!VECTOR_CONSTANT_EVALUATED()) { ++baseIteratorsPtrCreated; } }
+	VECTOR_CONSTEXPR void onBaseIteratorDestroyed () noexcept { if (!VECTOR_CONSTANT_EVALUATED()) { ++baseIteratorsDestroyed; } }
+
+	VECTOR_CONSTEXPR void onContainerHostCreated () noexcept { if (!VECTOR_CONSTANT_EVALUATED()) { ++containersHostCreated; } }
+	VECTOR_CONSTEXPR void onContainerDestroyed () noexcept { if (!VECTOR_CONSTANT_EVALUATED()) { ++containersDestroyed; } }
 };
 
 //use this object to trace memory flows
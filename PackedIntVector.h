@@ -0,0 +1,366 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "Vector.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_FULL_VER) && _MSC_FULL_VER < 180000000
+#define noexcept throw()
+#endif
+
+//Block codecs of PackedIntVector.
+//A frame-of-reference block stores value - base in 'width' bits per value. The 128 values are split
+//into 4 interleaved lanes (value i goes to lane i % 4), each lane is packed into 'width' 32-bit words
+//and word j of lane l is stored at index j * 4 + l, so that one 128-bit load brings a word of every lane.
+
+namespace packed_detail {
+	const size_t BLOCK_SIZE = 128;
+	const size_t LANES = 4;
+	const size_t MAX_VARINT_BYTES = 5;
+
+	enum BlockEncoding {
+		FRAME_OF_REFERENCE,
+		DELTA_VARINT
+	};
+
+	struct Block {
+		int32_t base;		//minimum (frame of reference) or first value (delta)
+		uint32_t offset;	//first payload word
+		uint32_t width;		//bits per value (frame of reference only)
+		uint32_t encoding;
+	};
+
+	inline uint32_t widthOf (uint32_t value) noexcept {
+		uint32_t width = 0;
+		for (; value; value >>= 1) {
+			++width;
+		}
+		return width;
+	}
+
+	inline uint32_t maskOf (uint32_t width) noexcept {
+		return width >= 32 ? 0xFFFFFFFFu : (1u << width) - 1;
+	}
+
+	inline uint32_t zigzag (uint32_t delta) noexcept {
+		return (delta << 1) ^ (0u - (delta >> 31));
+	}
+
+	inline uint32_t unzigzag (uint32_t value) noexcept {
+		return (value >> 1) ^ (0u - (value & 1));
+	}
+
+	//'offsets' (BLOCK_SIZE values) into width * LANES words
+	inline void pack (const uint32_t *offsets, uint32_t width, uint32_t *out) noexcept {
+		for (size_t lane = 0; lane < LANES; ++lane) {
+			uint64_t buffer = 0;
+			uint32_t filled = 0;
+			size_t word = 0;
+
+			for (size_t k = 0; k < BLOCK_SIZE / LANES; ++k) {
+				buffer |= static_cast<uint64_t>(offsets[k * LANES + lane]) << filled;
+				filled += width;
+				if (filled >= 32) {
+					out[word++ * LANES + lane] = static_cast<uint32_t>(buffer);
+					buffer >>= 32;
+					filled -= 32;
+				}
+			}
+		}
+	}
+
+	//value 'index' of a packed block
+	inline int32_t unpackOne (const uint32_t *in, uint32_t width, int32_t base, size_t index) noexcept {
+		size_t lane = index % LANES;
+		size_t bit = (index / LANES) * width;
+		uint32_t shift = static_cast<uint32_t>(bit % 32);
+		size_t word = bit / 32;
+
+		uint32_t value = width ? in[word * LANES + lane] >> shift : 0;
+		if (shift + width > 32) {
+			value |= in[(word + 1) * LANES + lane] << (32 - shift);
+		}
+		return static_cast<int32_t>(static_cast<uint32_t>(base) + (value & maskOf(width)));
+	}
+
+	inline void unpackScalar (const uint32_t *in, uint32_t width, int32_t base, int32_t *out) noexcept {
+		uint32_t mask = maskOf(width);
+
+		for (size_t lane = 0; lane < LANES; ++lane) {
+			uint64_t buffer = 0;
+			uint32_t available = 0;
+			size_t word = 0;
+
+			for (size_t k = 0; k < BLOCK_SIZE / LANES; ++k) {
+				if (available < width) {
+					buffer |= static_cast<uint64_t>(in[word++ * LANES + lane]) << available;
+					available += 32;
+				}
+				out[k * LANES + lane] = static_cast<int32_t>(static_cast<uint32_t>(base) + (static_cast<uint32_t>(buffer) & mask));
+				buffer >>= width;
+				available -= width;
+			}
+		}
+	}
+
+	#ifdef __SSE2__
+	//all 4 lanes at once: every step is the same shift of the same word in each lane
+	inline void unpack (const uint32_t *in, uint32_t width, int32_t base, int32_t *out) noexcept {
+		__m128i baseVector = _mm_set1_epi32(base);
+
+		if (width == 0) {
+			for (size_t k = 0; k < BLOCK_SIZE; k += LANES) {
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out + k), baseVector);
+			}
+			return;
+		}
+
+		__m128i mask = _mm_set1_epi32(static_cast<int>(maskOf(width)));
+		const __m128i *words = reinterpret_cast<const __m128i*>(in);
+		__m128i current = _mm_loadu_si128(words++);
+		uint32_t shift = 0;
+
+		for (size_t k = 0; k < BLOCK_SIZE; k += LANES) {
+			__m128i value = _mm_srl_epi32(current, _mm_cvtsi32_si128(static_cast<int>(shift)));
+
+			if (shift + width > 32) {
+				current = _mm_loadu_si128(words++);
+				value = _mm_or_si128(value, _mm_sll_epi32(current, _mm_cvtsi32_si128(static_cast<int>(32 - shift))));
+				shift = shift + width - 32;
+			}
+			else if (shift + width == 32) {
+				if (k + LANES < BLOCK_SIZE) {
+					current = _mm_loadu_si128(words++);
+				}
+				shift = 0;
+			}
+			else {
+				shift += width;
+			}
+
+			value = _mm_add_epi32(_mm_and_si128(value, mask), baseVector);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + k), value);
+		}
+	}
+	#else
+	inline void unpack (const uint32_t *in, uint32_t width, int32_t base, int32_t *out) noexcept {
+		unpackScalar(in, width, base, out);
+	}
+	#endif
+
+	//zigzag varints of the differences between neighbours, returns the number of bytes written
+	inline size_t encodeDeltas (const int32_t *values, unsigned char *out) noexcept {
+		size_t length = 0;
+		for (size_t i = 1; i < BLOCK_SIZE; ++i) {
+			uint32_t value = zigzag(static_cast<uint32_t>(values[i]) - static_cast<uint32_t>(values[i - 1]));
+			while (value >= 0x80) {
+				out[length++] = static_cast<unsigned char>(value | 0x80);
+				value >>= 7;
+			}
+			out[length++] = static_cast<unsigned char>(value);
+		}
+		return length;
+	}
+
+	inline uint32_t readVarint (const unsigned char *&in) noexcept {
+		uint32_t value = 0;
+		uint32_t shift = 0;
+		unsigned char byte;
+		do {
+			byte = *in++;
+			value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+			shift += 7;
+		} while (byte & 0x80);
+		return value;
+	}
+
+	//value 'index' of a delta block: the varints before it are summed, nothing is stored
+	inline int32_t decodeDeltaAt (const unsigned char *in, int32_t base, size_t index) noexcept {
+		uint32_t current = static_cast<uint32_t>(base);
+
+		for (size_t i = 0; i < index; ++i) {
+			current += unzigzag(readVarint(in));
+		}
+		return static_cast<int32_t>(current);
+	}
+
+	inline void decodeDeltas (const unsigned char *in, int32_t base, int32_t *out) noexcept {
+		uint32_t current = static_cast<uint32_t>(base);
+		out[0] = base;
+
+		for (size_t i = 1; i < BLOCK_SIZE; ++i) {
+			current += unzigzag(readVarint(in));
+			out[i] = static_cast<int32_t>(current);
+		}
+	}
+}
+
+///<summary>
+///Append-only compressed vector of int32_t.
+///Values are encoded in independent blocks of 128, each either frame-of-reference bit-packed
+///(small or clustered values) or delta + zigzag varint encoded (sorted or slowly changing values),
+///whichever is smaller. The last incomplete block is kept unencoded.
+///Random access is O(1) for bit-packed blocks and decodes the varints up to the value for delta blocks;
+///it keeps no state, so concurrent readers are safe. Sequential reads should use decode_block() or decode().
+///</summary>
+class PackedIntVector {
+private:
+	Vector<packed_detail::Block> blocks;
+	Vector<uint32_t> payload;
+	int32_t tail[packed_detail::BLOCK_SIZE];	//values of the incomplete block
+	size_t tailSize;
+
+	void encodeTail () {
+		using namespace packed_detail;
+
+		int32_t minimum = tail[0], maximum = tail[0];
+		for (size_t i = 1; i < BLOCK_SIZE; ++i) {
+			minimum = tail[i] < minimum ? tail[i] : minimum;
+			maximum = tail[i] > maximum ? tail[i] : maximum;
+		}
+		uint32_t width = widthOf(static_cast<uint32_t>(maximum) - static_cast<uint32_t>(minimum));
+
+		unsigned char bytes[BLOCK_SIZE * MAX_VARINT_BYTES + sizeof(uint32_t)];
+		size_t byteCount = encodeDeltas(tail, bytes);
+		size_t varintWords = (byteCount + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+		Block block;
+		block.offset = static_cast<uint32_t>(payload.size());
+		block.width = width;
+
+		uint32_t words[BLOCK_SIZE];
+		size_t wordCount;
+		if (varintWords < width * LANES) {
+			block.encoding = DELTA_VARINT;
+			block.base = tail[0];
+			memset(bytes + byteCount, 0, varintWords * sizeof(uint32_t) - byteCount);
+			memcpy(words, bytes, varintWords * sizeof(uint32_t));
+			wordCount = varintWords;
+		}
+		else {
+			block.encoding = FRAME_OF_REFERENCE;
+			block.base = minimum;
+			uint32_t offsets[BLOCK_SIZE];
+			for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+				offsets[i] = static_cast<uint32_t>(tail[i]) - static_cast<uint32_t>(minimum);
+			}
+			pack(offsets, width, words);
+			wordCount = width * LANES;
+		}
+
+		for (size_t i = 0; i < wordCount; ++i) {
+			payload.push_back(words[i]);
+		}
+		blocks.push_back(block);
+		tailSize = 0;
+	}
+
+public:
+	typedef int32_t value_type;
+
+	static const size_t block_size = packed_detail::BLOCK_SIZE;
+
+	PackedIntVector () : tailSize(0) { }
+
+	explicit PackedIntVector (const Vector<int32_t> &values) : tailSize(0) {
+		const int32_t *data = values.data();
+		for (size_t i = 0, sz = values.size(); i < sz; ++i) {
+			push_back(data[i]);
+		}
+	}
+
+	template <typename InputIterator>
+	PackedIntVector (InputIterator begin, InputIterator end) : tailSize(0) {
+		for (InputIterator i = begin; i != end; ++i) {
+			push_back(*i);
+		}
+	}
+
+	size_t size () const noexcept { return blocks.size() * block_size + tailSize; }
+	bool empty () const noexcept { return size() == 0; }
+
+	//number of encoded blocks (the incomplete tail is not counted)
+	size_t block_count () const noexcept { return blocks.size(); }
+
+	//bytes held by the encoded data and the tail
+	size_t memory_usage () const noexcept {
+		return blocks.capacity() * sizeof(packed_detail::Block) + payload.capacity() * sizeof(uint32_t) + sizeof(*this);
+	}
+
+	void push_back (int32_t value) {
+		tail[tailSize++] = value;
+		if (tailSize == block_size) {
+			encodeTail();
+		}
+	}
+
+	//drops the spare capacity left by growth of the encoded data
+	void shrink_to_fit () {
+		blocks.shrink_to_fit();
+		payload.shrink_to_fit();
+	}
+
+	void clear () noexcept {
+		blocks.clear();
+		payload.clear();
+		tailSize = 0;
+	}
+
+	int32_t operator[] (size_t index) const {
+		if (index >= size()) {
+			VECTOR_THROW(IndexOutOfRangeException ("Index out of range"));
+		}
+
+		size_t blockIndex = index / block_size;
+		if (blockIndex == blocks.size()) {
+			return tail[index % block_size];
+		}
+
+		const packed_detail::Block &block = blocks.data()[blockIndex];
+		if (block.encoding == packed_detail::FRAME_OF_REFERENCE) {
+			return packed_detail::unpackOne(payload.data() + block.offset, block.width, block.base, index % block_size);
+		}
+		return packed_detail::decodeDeltaAt(reinterpret_cast<const unsigned char*>(payload.data() + block.offset), block.base, index % block_size);
+	}
+
+	//decodes the whole block 'index' into out[0 .. block_size)
+	void decode_block (size_t index, int32_t *out) const {
+		if (index >= blocks.size()) {
+			VECTOR_THROW(IndexOutOfRangeException ("Block index out of range"));
+		}
+
+		const packed_detail::Block &block = blocks.data()[index];
+		const uint32_t *words = payload.data() + block.offset;
+		if (block.encoding == packed_detail::FRAME_OF_REFERENCE) {
+			packed_detail::unpack(words, block.width, block.base, out);
+		}
+		else {
+			packed_detail::decodeDeltas(reinterpret_cast<const unsigned char*>(words), block.base, out);
+		}
+	}
+
+	//appends all values to 'out': one reserve, then every block is decoded straight into its storage
+	void decode (Vector<int32_t> &out) const {
+		out.reserve(out.size() + size());
+
+		int32_t *target = out.uninitializedEnd();
+		for (size_t b = 0, sz = blocks.size(); b < sz; ++b) {
+			decode_block(b, target + b * block_size);
+		}
+		if (tailSize) {
+			memcpy(target + blocks.size() * block_size, tail, tailSize * sizeof(int32_t));
+		}
+		out.commitAppended(size());
+	}
+
+	Vector<int32_t> to_vector () const {
+		Vector<int32_t> result;
+		decode(result);
+		return result;
+	}
+};
@@ -0,0 +1,568 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <new>
+#include <utility>
+#include "Vector.h"
+
+#if defined(_MSC_FULL_VER) && _MSC_FULL_VER < 180000000
+#define noexcept throw()
+#endif
+
+const unsigned PERSISTENT_BITS = 5;
+const size_t PERSISTENT_BRANCH = 32;	//children of a trie node, elements of a leaf
+const size_t PERSISTENT_MASK = PERSISTENT_BRANCH - 1;
+
+template <typename T>
+class PersistentVector;
+
+template <typename T>
+class TransientVector;
+
+namespace persistent_detail {
+	//Nodes are shared between versions and counted. 'owner' is the id of the TransientVector that made the node
+	//and may still edit it in place, 0 for nodes of persistent versions, which are never modified.
+	struct Node {
+		std::atomic<size_t> refs;
+		uint64_t owner;
+		bool leaf;
+
+		Node (uint64_t owner, bool leaf) noexcept : refs(1), owner(owner), leaf(leaf) { }
+	};
+
+	struct Branch : Node {
+		Node *children[PERSISTENT_BRANCH];
+
+		explicit Branch (uint64_t owner) noexcept : Node(owner, false) {
+			for (size_t i = 0; i < PERSISTENT_BRANCH; ++i) {
+				children[i] = nullptr;
+			}
+		}
+	};
+
+	template <typename T>
+	struct Leaf : Node {
+		size_t count;
+		alignas(T) unsigned char storage[PERSISTENT_BRANCH * sizeof(T)];
+
+		explicit Leaf (uint64_t owner) noexcept : Node(owner, true), count(0) { }
+
+		T* items () noexcept { return reinterpret_cast<T*>(storage); }
+		const T* items () const noexcept { return reinterpret_cast<const T*>(storage); }
+	};
+
+	inline uint64_t newOwner () noexcept {
+		static std::atomic<uint64_t> lastOwner(0);
+		return ++lastOwner;
+	}
+
+	inline bool owns (const Node *node, uint64_t owner) noexcept {
+		return owner != 0 && node->owner == owner;
+	}
+
+	///<summary>
+	///32-way trie with a tail leaf (Bagwell / Clojure persistent vector), the state shared by PersistentVector
+	///and TransientVector. Leaves are at level 0, the root at level 'shift'. Elements [0, tailOffset()) are in
+	///full leaves of the trie, the rest in 'tail', so push_back touches the trie once every 32 elements.
+	///The editing methods copy every node on the path they change unless it is owned by 'owner'.
+	///Exception safety: a failed edit leaves the trie as it was.
+	///</summary>
+	template <typename T>
+	class Trie {
+	private:
+		typedef Leaf<T> LeafNode;
+
+		static void retain (Node *node) noexcept {
+			if (node) {
+				node->refs.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		static void release (Node *node) noexcept {
+			if (!node || node->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+				return;
+			}
+			if (node->leaf) {
+				LeafNode *leaf = static_cast<LeafNode*>(node);
+				vector_detail::destroyRange(leaf->items(), leaf->items() + leaf->count);
+				delete leaf;
+			}
+			else {
+				Branch *branch = static_cast<Branch*>(node);
+				for (size_t i = 0; i < PERSISTENT_BRANCH && branch->children[i]; ++i) {
+					release(branch->children[i]);
+				}
+				delete branch;
+			}
+		}
+
+		static Branch* cloneBranch (const Branch *branch, uint64_t owner) {
+			Branch *copy = new Branch (owner);
+			for (size_t i = 0; i < PERSISTENT_BRANCH; ++i) {
+				copy->children[i] = branch->children[i];
+				retain(copy->children[i]);
+			}
+			return copy;
+		}
+
+		static LeafNode* cloneLeaf (const LeafNode *leaf, uint64_t owner) {
+			LeafNode *copy = new LeafNode (owner);
+			VECTOR_TRY {
+				for (; copy->count < leaf->count; ++copy->count) {
+					new(copy->items() + copy->count) T(leaf->items()[copy->count]);
+				}
+			}
+			VECTOR_CATCH_ALL {
+				release(copy);
+				VECTOR_RETHROW;
+			}
+			return copy;
+		}
+
+		//chain of new branches from 'level' down to 'leaf'
+		static Node* newPath (unsigned level, LeafNode *leaf, uint64_t owner) {
+			if (level == 0) {
+				return leaf;
+			}
+			Branch *branch = new Branch (owner);
+			VECTOR_TRY {
+				branch->children[0] = newPath(level - PERSISTENT_BITS, leaf, owner);
+			}
+			VECTOR_CATCH_ALL {
+				delete branch;
+				VECTOR_RETHROW;
+			}
+			return branch;
+		}
+
+		//the following take over the caller's reference to 'node' on success and return the new node
+
+		//links the full 'leaf' as the last leaf under 'node' (nullptr: no node yet)
+		Branch* pushLeaf (unsigned level, Branch *node, LeafNode *leaf, uint64_t owner) {
+			Branch *result = node ? (owns(node, owner) ? node : cloneBranch(node, owner)) : new Branch (owner);
+			size_t slot = ((count - 1) >> level) & PERSISTENT_MASK;
+			Node *child;
+			VECTOR_TRY {
+				child = level == PERSISTENT_BITS ? leaf
+					: result->children[slot] ? pushLeaf(level - PERSISTENT_BITS, static_cast<Branch*>(result->children[slot]), leaf, owner)
+					: newPath(level - PERSISTENT_BITS, leaf, owner);
+			}
+			VECTOR_CATCH_ALL {
+				if (result != node) {
+					release(result);
+				}
+				VECTOR_RETHROW;
+			}
+			result->children[slot] = child;
+			if (result != node) {
+				release(node);
+			}
+			return result;
+		}
+
+		template <typename Value>
+		Node* assign (unsigned level, Node *node, size_t index, Value &&value, uint64_t owner) {
+			if (level == 0) {
+				LeafNode *leaf = static_cast<LeafNode*>(node);
+				if (owns(leaf, owner)) {
+					leaf->items()[index & PERSISTENT_MASK] = std::forward<Value>(value);
+					return leaf;
+				}
+				LeafNode *copy = cloneLeaf(leaf, owner);
+				VECTOR_TRY {
+					copy->items()[index & PERSISTENT_MASK] = std::forward<Value>(value);
+				}
+				VECTOR_CATCH_ALL {
+					release(copy);
+					VECTOR_RETHROW;
+				}
+				release(leaf);
+				return copy;
+			}
+
+			Branch *branch = static_cast<Branch*>(node);
+			Branch *result = owns(branch, owner) ? branch : cloneBranch(branch, owner);
+			size_t slot = (index >> level) & PERSISTENT_MASK;
+			Node *child;
+			VECTOR_TRY {
+				child = assign(level - PERSISTENT_BITS, result->children[slot], index, std::forward<Value>(value), owner);
+			}
+			VECTOR_CATCH_ALL {
+				if (result != branch) {
+					release(result);
+				}
+				VECTOR_RETHROW;
+			}
+			result->children[slot] = child;
+			if (result != branch) {
+				release(branch);
+			}
+			return result;
+		}
+
+	public:
+		size_t count;
+		unsigned shift;
+		Branch *root;
+		LeafNode *tail;
+
+		Trie () noexcept : count(0), shift(PERSISTENT_BITS), root(nullptr), tail(nullptr) { }
+
+		Trie (const Trie<T> &other) noexcept : count(other.count), shift(other.shift), root(other.root), tail(other.tail) {
+			retain(root);
+			retain(tail);
+		}
+
+		Trie (Trie<T> &&other) noexcept : count(other.count), shift(other.shift), root(other.root), tail(other.tail) {
+			other.count = 0;
+			other.shift = PERSISTENT_BITS;
+			other.root = nullptr;
+			other.tail = nullptr;
+		}
+
+		Trie<T>& operator= (Trie<T> other) noexcept {
+			swap(other);
+			return *this;
+		}
+
+		~Trie () noexcept {
+			release(root);
+			release(tail);
+		}
+
+		void swap (Trie<T> &other) noexcept {
+			std::swap(count, other.count);
+			std::swap(shift, other.shift);
+			std::swap(root, other.root);
+			std::swap(tail, other.tail);
+		}
+
+		size_t tailOffset () const noexcept {
+			return count < PERSISTENT_BRANCH ? 0 : ((count - 1) >> PERSISTENT_BITS) << PERSISTENT_BITS;
+		}
+
+		//elements of the leaf holding 'index'
+		const T* leafFor (size_t index) const noexcept {
+			if (index >= tailOffset()) {
+				return tail->items();
+			}
+			const Node *node = root;
+			for (unsigned level = shift; level > 0; level -= PERSISTENT_BITS) {
+				node = static_cast<const Branch*>(node)->children[(index >> level) & PERSISTENT_MASK];
+			}
+			return static_cast<const LeafNode*>(node)->items();
+		}
+
+		template <typename Value>
+		void push (Value &&value, uint64_t owner) {
+			if (tail && count - tailOffset() < PERSISTENT_BRANCH) {
+				if (owns(tail, owner)) {
+					new(tail->items() + tail->count) T(std::forward<Value>(value));
+					++tail->count;
+				}
+				else {
+					LeafNode *copy = cloneLeaf(tail, owner);
+					VECTOR_TRY {
+						new(copy->items() + copy->count) T(std::forward<Value>(value));
+					}
+					VECTOR_CATCH_ALL {
+						release(copy);
+						VECTOR_RETHROW;
+					}
+					++copy->count;
+					release(tail);
+					tail = copy;
+				}
+				++count;
+				return;
+			}
+
+			//the tail is full (or missing): it moves into the trie, the element starts a new tail
+			LeafNode *newTail = new LeafNode (owner);
+			VECTOR_TRY {
+				new(newTail->items()) T(std::forward<Value>(value));
+			}
+			VECTOR_CATCH_ALL {
+				delete newTail;
+				VECTOR_RETHROW;
+			}
+			newTail->count = 1;
+
+			if (tail) {
+				VECTOR_TRY {
+					if ((count >> PERSISTENT_BITS) > (static_cast<size_t>(1) << shift)) {
+						//the trie is full: it grows a level
+						Branch *newRoot = new Branch (owner);
+						VECTOR_TRY {
+							newRoot->children[1] = newPath(shift, tail, owner);
+						}
+						VECTOR_CATCH_ALL {
+							delete newRoot;
+							VECTOR_RETHROW;
+						}
+						newRoot->children[0] = root;
+						root = newRoot;
+						shift += PERSISTENT_BITS;
+					}
+					else {
+						root = pushLeaf(shift, root, tail, owner);
+					}
+				}
+				VECTOR_CATCH_ALL {
+					release(newTail);
+					VECTOR_RETHROW;
+				}
+			}
+			tail = newTail;
+			++count;
+		}
+
+		template <typename Value>
+		void set (size_t index, Value &&value, uint64_t owner) {
+			if (index >= tailOffset()) {
+				tail = static_cast<LeafNode*>(assign(0, tail, index, std::forward<Value>(value), owner));
+			}
+			else {
+				root = static_cast<Branch*>(assign(shift, root, index, std::forward<Value>(value), owner));
+			}
+		}
+
+		//calls fn(const T *items, size_t count) for every leaf in order
+		template <typename Function>
+		void forEachLeaf (Function fn) const {
+			for (size_t offset = 0; offset < tailOffset(); offset += PERSISTENT_BRANCH) {
+				fn(leafFor(offset), PERSISTENT_BRANCH);
+			}
+			if (tail) {
+				fn(tail->items(), tail->count);
+			}
+		}
+	};
+}
+
+///<summary>
+///Read-only iterator of PersistentVector and TransientVector: an index and the leaf holding it,
+///looked up again once every 32 elements. Valid while the iterated version exists.
+///</summary>
+template <typename T>
+class PersistentIterator {
+private:
+	const persistent_detail::Trie<T> *trie;
+	size_t index;
+	const T *leaf;
+
+	template <typename U> friend class PersistentVector;
+	template <typename U> friend class TransientVector;
+
+	PersistentIterator (const persistent_detail::Trie<T> *trie, size_t index) noexcept
+		: trie(trie), index(index), leaf(index < trie->count ? trie->leafFor(index) : nullptr) { }
+
+public:
+	typedef std::forward_iterator_tag iterator_category;
+	typedef T value_type;
+	typedef ptrdiff_t difference_type;
+	typedef const T* pointer;
+	typedef const T& reference;
+
+	PersistentIterator () noexcept : trie(nullptr), index(0), leaf(nullptr) { }
+
+	const T& operator* () const noexcept { return leaf[index & PERSISTENT_MASK]; }
+	const T* operator-> () const noexcept { return leaf + (index & PERSISTENT_MASK); }
+
+	PersistentIterator& operator++ () noexcept {
+		++index;
+		if ((index & PERSISTENT_MASK) == 0) {
+			leaf = index < trie->count ? trie->leafFor(index) : nullptr;
+		}
+		return *this;
+	}
+
+	PersistentIterator operator++ (int) noexcept { PersistentIterator clone(*this); ++*this; return clone; }
+
+	bool operator== (const PersistentIterator &another) const noexcept { return index == another.index && trie == another.trie; }
+	bool operator!= (const PersistentIterator &another) const noexcept { return !(*this == another); }
+};
+
+///<summary>
+///Immutable vector with structural sharing: push_back and set return a new version in O(log32 n),
+///copying only the path to the changed leaf; copying a version is O(1) (two reference counts), so a snapshot
+///costs nothing and k snapshots take one copy of the elements plus the changed leaves.
+///Versions may be read and copied from several threads. Batched edits go through transient().
+///</summary>
+template <typename T>
+class PersistentVector {
+private:
+	typedef persistent_detail::Trie<T> Trie;
+
+	Trie trie;
+
+	friend class TransientVector<T>;
+
+	explicit PersistentVector (const Trie &trie) noexcept : trie(trie) { }
+
+	void checkIndex (size_t index) const {
+		if (index >= trie.count) {
+			VECTOR_THROW(IndexOutOfRangeException ("Index out of range"));
+		}
+	}
+
+public:
+	typedef T value_type;
+	typedef PersistentIterator<T> const_iterator;
+	typedef const_iterator iterator;
+
+	PersistentVector () noexcept { }
+
+	explicit PersistentVector (const Vector<T> &items);
+
+	size_t size () const noexcept { return trie.count; }
+	bool empty () const noexcept { return trie.count == 0; }
+
+	const T& operator[] (size_t index) const {
+		checkIndex(index);
+		return trie.leafFor(index)[index & PERSISTENT_MASK];
+	}
+
+	const T& at (size_t index) const { return (*this)[index]; }
+
+	PersistentVector<T> push_back (const T &value) const {
+		PersistentVector<T> result (*this);
+		result.trie.push(value, 0);
+		return result;
+	}
+
+	PersistentVector<T> push_back (T &&value) const {
+		PersistentVector<T> result (*this);
+		result.trie.push(std::move(value), 0);
+		return result;
+	}
+
+	PersistentVector<T> set (size_t index, const T &value) const {
+		checkIndex(index);
+		PersistentVector<T> result (*this);
+		result.trie.set(index, value, 0);
+		return result;
+	}
+
+	//builder for batched edits, starting from this version
+	TransientVector<T> transient () const;
+
+	Vector<T> to_vector () const;
+
+	const_iterator begin () const noexcept { return const_iterator (&trie, 0); }
+	const_iterator end () const noexcept { return const_iterator (&trie, trie.count); }
+	const_iterator cbegin () const noexcept { return begin(); }
+	const_iterator cend () const noexcept { return end(); }
+};
+
+///<summary>
+///Mutable builder of a PersistentVector: edits nodes it made itself in place and copies shared ones once,
+///so a batch of push_back/set costs about as much as on a Vector. persistent() returns the current contents
+///as a PersistentVector in O(1); later edits of the builder copy the nodes they share with it.
+///A copy of a builder is another builder: the two stop editing the nodes they share in place.
+///Not thread safe.
+///</summary>
+template <typename T>
+class TransientVector {
+private:
+	typedef persistent_detail::Trie<T> Trie;
+
+	Trie trie;
+	mutable uint64_t owner;	//copying gives the source a new id too: its nodes become shared
+
+	friend class PersistentVector<T>;
+
+public:
+	typedef T value_type;
+	typedef PersistentIterator<T> const_iterator;
+	typedef const_iterator iterator;
+
+	TransientVector () noexcept : owner(persistent_detail::newOwner()) { }
+
+	explicit TransientVector (const PersistentVector<T> &from) noexcept : trie(from.trie), owner(persistent_detail::newOwner()) { }
+
+	TransientVector (const TransientVector<T> &other) noexcept : trie(other.trie), owner(persistent_detail::newOwner()) {
+		other.owner = persistent_detail::newOwner();
+	}
+
+	TransientVector (TransientVector<T> &&other) noexcept : trie(std::move(other.trie)), owner(other.owner) {
+		other.owner = persistent_detail::newOwner();
+	}
+
+	TransientVector<T>& operator= (const TransientVector<T> &other) noexcept {
+		trie = other.trie;
+		owner = persistent_detail::newOwner();
+		other.owner = persistent_detail::newOwner();
+		return *this;
+	}
+
+	TransientVector<T>& operator= (TransientVector<T> &&other) noexcept {
+		trie = std::move(other.trie);
+		owner = other.owner;
+		other.owner = persistent_detail::newOwner();
+		return *this;
+	}
+
+	size_t size () const noexcept { return trie.count; }
+	bool empty () const noexcept { return trie.count == 0; }
+
+	const T& operator[] (size_t index) const {
+		if (index >= trie.count) {
+			VECTOR_THROW(IndexOutOfRangeException ("Index out of range"));
+		}
+		return trie.leafFor(index)[index & PERSISTENT_MASK];
+	}
+
+	void push_back (const T &value) { trie.push(value, owner); }
+	void push_back (T &&value) { trie.push(std::move(value), owner); }
+
+	void set (size_t index, const T &value) {
+		if (index >= trie.count) {
+			VECTOR_THROW(IndexOutOfRangeException ("Index out of range"));
+		}
+		trie.set(index, value, owner);
+	}
+
+	PersistentVector<T> persistent () {
+		//the nodes made so far now belong to the returned version: a new id stops editing them in place
+		owner = persistent_detail::newOwner();
+		return PersistentVector<T> (trie);
+	}
+
+	const_iterator begin () const noexcept { return const_iterator (&trie, 0); }
+	const_iterator end () const noexcept { return const_iterator (&trie, trie.count); }
+};
+
+#pragma region PersistentVector implementation
+
+template <typename T>
+PersistentVector<T>::PersistentVector (const Vector<T> &items) {
+	TransientVector<T> builder;
+	const T *first = items.data();
+	for (size_t i = 0; i < items.size(); ++i) {
+		builder.push_back(first[i]);
+	}
+	trie = std::move(builder.trie);
+}
+
+template <typename T>
+TransientVector<T> PersistentVector<T>::transient () const {
+	return TransientVector<T> (*this);
+}
+
+template <typename T>
+Vector<T> PersistentVector<T>::to_vector () const {
+	Vector<T> result;
+	result.reserve(trie.count);
+	trie.forEachLeaf([&result](const T *items, size_t count) {
+		for (size_t i = 0; i < count; ++i) {
+			result.push_back(items[i]);
+		}
+	});
+	return result;
+}
+
+#pragma endregion
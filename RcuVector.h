@@ -0,0 +1,290 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include "Vector.h"
+
+#if defined(_MSC_FULL_VER) && _MSC_FULL_VER < 180000000
+#define noexcept throw()
+#endif
+
+namespace rcu_detail {
+	//Epoch announced by one reader thread, 0 while it reads nothing. Padded to keep readers off each other's cache lines.
+	struct ReaderSlot {
+		std::atomic<uint64_t> epoch;
+		std::atomic<bool> inUse;
+		ReaderSlot *next;
+		char padding[CACHE_LINE_SIZE];
+
+		ReaderSlot () noexcept : epoch(0), inUse(true), next(nullptr) { }
+	};
+
+	///<summary>
+	///Epoch-based reclamation shared by all RcuVectors. Readers announce the global epoch before loading a buffer,
+	///a writer retires a replaced buffer with the epoch current at its replacement and advances the epoch:
+	///the buffer is freed once no reader announces that epoch or an older one.
+	///Slots are never freed, a slot of an exited thread is reused by the next new reader thread.
+	///</summary>
+	class Domain {
+	private:
+		std::atomic<uint64_t> globalEpoch;
+		std::atomic<ReaderSlot*> slots;
+
+		Domain () noexcept : globalEpoch(1), slots(nullptr) { }
+
+		ReaderSlot* acquireSlot () {
+			for (ReaderSlot *slot = slots.load(std::memory_order_acquire); slot; slot = slot->next) {
+				bool expected = false;
+				if (!slot->inUse.load(std::memory_order_relaxed) && slot->inUse.compare_exchange_strong(expected, true)) {
+					return slot;
+				}
+			}
+
+			ReaderSlot *slot = new ReaderSlot ();
+			slot->next = slots.load(std::memory_order_relaxed);
+			while (!slots.compare_exchange_weak(slot->next, slot)) { }
+			return slot;
+		}
+
+		//slot of the calling thread with the nesting depth of its read guards
+		struct LocalSlot {
+			ReaderSlot *slot;
+			size_t depth;
+
+			LocalSlot () : slot(Domain::instance().acquireSlot()), depth(0) { }
+
+			~LocalSlot () {
+				slot->epoch.store(0, std::memory_order_release);
+				slot->inUse.store(false, std::memory_order_release);
+			}
+		};
+
+	public:
+		static Domain& instance () {
+			static Domain domain;
+			return domain;
+		}
+
+		static LocalSlot& local () {
+			static thread_local LocalSlot slot;
+			return slot;
+		}
+
+		void enter () {
+			LocalSlot &local = Domain::local();
+			if (local.depth++ == 0) {
+				local.slot->epoch.store(globalEpoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+			}
+		}
+
+		void leave () noexcept {
+			LocalSlot &local = Domain::local();
+			if (--local.depth == 0) {
+				local.slot->epoch.store(0, std::memory_order_release);
+			}
+		}
+
+		//epoch to tag a buffer that was just unpublished with; advances the global epoch
+		uint64_t retire () noexcept {
+			return globalEpoch.fetch_add(1, std::memory_order_seq_cst);
+		}
+
+		//buffers retired with an epoch below this one are not seen by any reader
+		uint64_t safeEpoch () const noexcept {
+			uint64_t oldest = globalEpoch.load(std::memory_order_seq_cst);
+			for (ReaderSlot *slot = slots.load(std::memory_order_acquire); slot; slot = slot->next) {
+				uint64_t epoch = slot->epoch.load(std::memory_order_seq_cst);
+				if (epoch && epoch < oldest) {
+					oldest = epoch;
+				}
+			}
+			return oldest;
+		}
+	};
+}
+
+template <typename T>
+class RcuVector;
+
+///<summary>
+///Read-side critical section of RcuVector: the Vector published when the guard was made, kept alive
+///until the guard is destroyed. Guards may nest; a thread must not publish while it holds one.
+///</summary>
+template <typename T>
+class RcuReadGuard {
+private:
+	const Vector<T> *snapshot;
+
+	friend class RcuVector<T>;
+
+	explicit RcuReadGuard (const std::atomic<const Vector<T>*> &current) : snapshot(nullptr) {
+		rcu_detail::Domain::instance().enter();
+		snapshot = current.load(std::memory_order_seq_cst);
+	}
+
+	#if defined(_MSC_FULL_VER) && _MSC_FULL_VER < 180000000
+	RcuReadGuard (const RcuReadGuard<T> &);
+	RcuReadGuard<T>& operator= (const RcuReadGuard<T> &);
+	#else
+	RcuReadGuard (const RcuReadGuard<T> &) = delete;
+	RcuReadGuard<T>& operator= (const RcuReadGuard<T> &) = delete;
+	#endif
+
+public:
+	RcuReadGuard (RcuReadGuard<T> &&other) noexcept : snapshot(other.snapshot) {
+		other.snapshot = nullptr;
+	}
+
+	~RcuReadGuard () noexcept {
+		if (snapshot) {
+			rcu_detail::Domain::instance().leave();
+		}
+	}
+
+	const Vector<T>& operator* () const noexcept { return *snapshot; }
+	const Vector<T>* operator-> () const noexcept { return snapshot; }
+	const Vector<T>& get () const noexcept { return *snapshot; }
+};
+
+///<summary>
+///Published snapshot of a Vector for data that is read often and rewritten rarely.
+///Readers take read() guards: an epoch announcement and a pointer load, no lock and no shared counter,
+///so reading scales with the cores. The writer builds a new Vector and publish()es it with one atomic
+///exchange; the replaced Vector is freed once every reader that could see it has left (epoch-based reclamation).
+///Writers are serialized by a mutex, readers never wait.
+///</summary>
+template <typename T>
+class RcuVector {
+private:
+	struct Retired {
+		const Vector<T> *items;
+		uint64_t epoch;
+	};
+
+	std::atomic<const Vector<T>*> current;
+	Vector<Retired> retiredItems;
+	std::mutex writer;
+
+	#if defined(_MSC_FULL_VER) && _MSC_FULL_VER < 180000000
+	RcuVector (const RcuVector<T> &);
+	RcuVector<T>& operator= (const RcuVector<T> &);
+	#else
+	RcuVector (const RcuVector<T> &) = delete;
+	RcuVector<T>& operator= (const RcuVector<T> &) = delete;
+	#endif
+
+	void replaceLocked (const Vector<T> *items);
+	size_t reclaimLocked ();
+
+public:
+	RcuVector () : current(new Vector<T> ()) { }
+	explicit RcuVector (Vector<T> items) : current(new Vector<T> (std::move(items))) { }
+
+	//no reader may be inside a guard of this vector
+	~RcuVector ();
+
+	RcuReadGuard<T> read () const {
+		return RcuReadGuard<T> (current);
+	}
+
+	//replaces the published Vector
+	void publish (Vector<T> items) {
+		const Vector<T> *published = new Vector<T> (std::move(items));
+		std::lock_guard<std::mutex> lock(writer);
+		replaceLocked(published);
+	}
+
+	//publishes a modified copy of the published Vector: fn(Vector<T> &)
+	template <typename Function>
+	void update (Function fn);
+
+	//frees the replaced Vectors no reader sees anymore, returns how many
+	size_t reclaim () {
+		std::lock_guard<std::mutex> lock(writer);
+		return reclaimLocked();
+	}
+
+	//waits until every replaced Vector is freed
+	void synchronize ();
+
+	//replaced Vectors waiting for readers
+	size_t retired () {
+		std::lock_guard<std::mutex> lock(writer);
+		return retiredItems.size();
+	}
+};
+
+#pragma region RcuVector implementation
+
+template <typename T>
+RcuVector<T>::~RcuVector () {
+	for (size_t i = 0; i < retiredItems.size(); ++i) {
+		delete retiredItems[i].items;
+	}
+	delete current.load(std::memory_order_relaxed);
+}
+
+template <typename T>
+void RcuVector<T>::replaceLocked (const Vector<T> *items) {
+	Retired retired;
+	retired.items = current.exchange(items, std::memory_order_seq_cst);
+	retired.epoch = rcu_detail::Domain::instance().retire();
+	VECTOR_TRY {
+		retiredItems.push_back(retired);
+	}
+	VECTOR_CATCH_ALL {
+		//no room to defer the free: wait for the readers instead
+		while (rcu_detail::Domain::instance().safeEpoch() <= retired.epoch) {
+			std::this_thread::yield();
+		}
+		delete retired.items;
+		VECTOR_RETHROW;
+	}
+	reclaimLocked();
+}
+
+template <typename T>
+size_t RcuVector<T>::reclaimLocked () {
+	uint64_t safe = rcu_detail::Domain::instance().safeEpoch();
+	size_t kept = 0;
+	for (size_t i = 0; i < retiredItems.size(); ++i) {
+		if (retiredItems[i].epoch < safe) {
+			delete retiredItems[i].items;
+		}
+		else {
+			retiredItems[kept++] = retiredItems[i];
+		}
+	}
+
+	size_t freed = retiredItems.size() - kept;
+	retiredItems.truncate(kept);
+	return freed;
+}
+
+template <typename T>
+template <typename Function>
+void RcuVector<T>::update (Function fn) {
+	std::lock_guard<std::mutex> lock(writer);
+	Vector<T> *items = new Vector<T> (*current.load(std::memory_order_relaxed));
+	VECTOR_TRY {
+		fn(*items);
+	}
+	VECTOR_CATCH_ALL {
+		delete items;
+		VECTOR_RETHROW;
+	}
+	replaceLocked(items);
+}
+
+template <typename T>
+void RcuVector<T>::synchronize () {
+	while (reclaim(), retired() > 0) {
+		std::this_thread::yield();
+	}
+}
+
+#pragma endregion
@@ -0,0 +1,664 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "Vector.h"
+
+#ifdef MEMORY_TRACE_MODE
+#include "MemoryWatcher.h"
+#endif
+
+#if defined(_MSC_FULL_VER) && _MSC_FULL_VER < 180000000
+#define noexcept throw()
+#endif
+
+#ifdef DEBUG_MODE
+#include <iostream>
+#endif
+
+template <typename T>
+class RingVector;
+
+//capacity of the first buffer of a RingVector
+const size_t RING_MIN_CAPACITY = 8;
+
+///<summary>
+///Checked iterator of RingVector. Remembers the absolute position of its element (number of elements
+///ever popped from the front before it), so it keeps pointing at the same element while the ring
+///wraps around and pops, and detects elements that were already popped.
+///Registers itself at the IteratorContainer of the ring and becomes invalid when the ring reallocates.
+///</summary>
+template <typename T>
+class RingIterator {
+private:
+	typedef typename std::remove_const<T>::type ValueType;
+	typedef RingVector<ValueType> Ring;
+	typedef IteratorContainer<RingIterator<T>, Ring> Container;
+
+	size_t position; //absolute position of the element
+	Container *container;
+	RingIterator *next; //next iterator in double-linked list (also in container)
+	RingIterator *prev; //prev iterator in double-linked list (also in container)
+
+	friend class IteratorContainer<RingIterator<T>, Ring>;
+	friend class RingVector<ValueType>;
+
+	template <typename T2>
+	friend class RingIterator;
+
+	RingIterator (size_t position, Container *container);
+
+	void selfRemoveFromContainer ();
+
+	void checkValidity () const {
+		if (!container || !container->vector) {
+			VECTOR_THROW(InvalidIteratorException());
+		}
+	}
+
+	template <typename T2>
+	void checkDomainEquality (const RingIterator<T2> &another) const {
+		checkValidity();
+		another.checkValidity();
+		if (static_cast<const void*>(container->vector) != static_cast<const void*>(another.container->vector)) {
+			VECTOR_THROW(DifferentIteratorDomainException());
+		}
+	}
+
+public:
+	typedef std::random_access_iterator_tag iterator_category;
+	typedef ValueType value_type;
+	typedef ptrdiff_t difference_type;
+	typedef T* pointer;
+	typedef T& reference;
+
+	RingIterator ();
+	RingIterator (const RingIterator<T> &iter);
+	~RingIterator ();
+
+	RingIterator& operator= (const RingIterator<T> &iter);
+
+	//iterator -> const_iterator
+	operator RingIterator<const ValueType> () const;
+
+	T& operator* () const { return (*this)[0]; }
+	T* operator-> () const { return &(*this)[0]; }
+	T& operator[] (ptrdiff_t offset) const;
+
+	RingIterator& operator+= (ptrdiff_t offset);
+	RingIterator& operator-= (ptrdiff_t offset) { return *this += -offset; }
+	RingIterator& operator++ () { return *this += 1; }
+	RingIterator& operator-- () { return *this -= 1; }
+	RingIterator operator++ (int) { RingIterator clone(*this); ++*this; return clone; }
+	RingIterator operator-- (int) { RingIterator clone(*this); --*this; return clone; }
+	RingIterator operator+ (ptrdiff_t offset) const { RingIterator result(*this); return result += offset; }
+	RingIterator operator- (ptrdiff_t offset) const { RingIterator result(*this); return result -= offset; }
+
+	template <typename T2>
+	ptrdiff_t operator- (const RingIterator<T2> &another) const {
+		checkDomainEquality(another);
+		return static_cast<ptrdiff_t>(position - another.position);
+	}
+
+	template <typename T2>
+	bool operator== (const RingIterator<T2> &another) const { checkDomainEquality(another); return position == another.position; }
+	template <typename T2>
+	bool operator!= (const RingIterator<T2> &another) const { return !(*this == another); }
+	template <typename T2>
+	bool operator< (const RingIterator<T2> &another) const { return *this - another < 0; }
+	template <typename T2>
+	bool operator> (const RingIterator<T2> &another) const { return another < *this; }
+	template <typename T2>
+	bool operator<= (const RingIterator<T2> &another) const { return !(another < *this); }
+	template <typename T2>
+	bool operator>= (const RingIterator<T2> &another) const { return !(*this < another); }
+
+	friend RingIterator operator+ (ptrdiff_t offset, const RingIterator &iter) { return iter + offset; }
+};
+
+///<summary>
+///FIFO queue on a circular buffer: O(1) push_back, pop_front and pop_back.
+///Capacity is a power of two, so a logical index maps to its slot with a mask.
+///The buffer is obtained with the same storage helpers and StorageOptions as Vector;
+///growth unwraps the ring with at most two bulk relocations (realloc/mremap plus one memcpy of the
+///wrapped part for trivially copyable elements, two move loops for the others).
+///Iterators are checked like Vector's: reallocation and clear() invalidate them,
+///an iterator to a popped element throws on access.
+///</summary>
+template <typename T>
+class RingVector {
+private:
+	T *buffer;
+	size_t ringCapacity;	//power of two or 0
+	size_t head;			//slot of the front element
+	size_t count;
+	size_t frontPosition;	//absolute position of the front element: number of elements popped from the front
+
+	StorageOptions storageOptions;
+
+	//made by the constructors; null after a move-out or an invalidation until the next iterator, see containers()
+	IteratorContainer<RingIterator<T>, RingVector<T>> *iteratorContainer;
+	IteratorContainer<RingIterator<const T>, RingVector<T>> *constIteratorContainer;
+
+	template <typename T2>
+	friend class RingIterator;
+
+	size_t slot (size_t index) const noexcept {
+		return (head + index) & (ringCapacity - 1);
+	}
+
+	//element at absolute position (for RingIterator), range is not checked
+	T* elementAt (size_t position) const noexcept {
+		return buffer + slot(position - frontPosition);
+	}
+
+	void initContainers () {
+		iteratorContainer = new IteratorContainer<RingIterator<T>, RingVector<T>> (this);
+		VECTOR_TRY {
+			constIteratorContainer = new IteratorContainer<RingIterator<const T>, RingVector<T>> (this);
+		}
+		VECTOR_CATCH_ALL { delete iteratorContainer; iteratorContainer = nullptr; VECTOR_RETHROW; }
+	}
+
+	//containers for a new iterator, created if the ring has none (never the case for a const object)
+	void containers () const {
+		if (!iteratorContainer) {
+			const_cast<RingVector<T>*>(this)->initContainers();
+		}
+	}
+
+	//does not allocate: the next iterator gets new containers
+	void invalidateIterators () noexcept {
+		if (iteratorContainer) {
+			iteratorContainer->invalidateAll();
+			constIteratorContainer->invalidateAll();
+			iteratorContainer = nullptr;
+			constIteratorContainer = nullptr;
+		}
+	}
+
+	//the elements occupy at most two runs of the buffer
+	void destroyElements () noexcept {
+		size_t firstRun = head + count > ringCapacity ? ringCapacity - head : count;
+		vector_detail::destroyRange (buffer + head, buffer + head + firstRun);
+		vector_detail::destroyRange (buffer, buffer + (count - firstRun));
+	}
+
+	void releaseBuffer () noexcept {
+		if (!buffer) {
+			return;
+		}
+
+		#ifdef MEMORY_TRACE_MODE
+		watcher.onMemoryDeallocated (std::distance (buffer, buffer + ringCapacity));
+		#endif
+
+		deallocateStorage (buffer, ringCapacity * sizeof(T), storageOptions);
+	}
+
+	//moves the elements into a buffer of new_capacity (a power of two >= 2 * capacity()) elements
+	void reallocate (size_t new_capacity);
+
+	//trivially copyable elements: the buffer is resized as raw bytes, the wrapped part is copied past the old end
+	T* relocate (size_t new_capacity, std::true_type);
+
+	//other elements are move-constructed to the beginning of a new buffer in two runs
+	T* relocate (size_t new_capacity, std::false_type);
+
+public:
+	typedef T value_type;
+	typedef RingIterator<T> iterator;
+	typedef RingIterator<const T> const_iterator;
+
+	typedef InvalidOperationException invalid_operation_exception;
+	typedef IndexOutOfRangeException index_out_of_range_exception;
+
+	RingVector ();
+	explicit RingVector (const StorageOptions &options);
+	RingVector (const RingVector<T> &other);
+	RingVector (RingVector<T> &&other) noexcept;
+	~RingVector () noexcept;
+
+	RingVector<T>& operator= (const RingVector<T> &other);
+	RingVector<T>& operator= (RingVector<T> &&other) noexcept;
+
+	void swap (RingVector<T> &other) noexcept;
+
+	bool empty () const noexcept { return count == 0; }
+	size_t size () const noexcept { return count; }
+	size_t capacity () const noexcept { return ringCapacity; }
+
+	void reserve (size_t new_capacity); //rounded up to a power of two
+	void clear () noexcept; //destroys the elements, keeps the buffer
+
+	T& operator[] (size_t index);
+	const T& operator[] (size_t index) const;
+
+	T& front ();
+	const T& front () const;
+	T& back ();
+	const T& back () const;
+
+	void push_back (const T &value);
+	void push_back (T &&value);
+	void pop_front ();
+	void pop_back ();
+
+	iterator begin () { containers(); return iterator (frontPosition, iteratorContainer); }
+	iterator end () { containers(); return iterator (frontPosition + count, iteratorContainer); }
+	const_iterator begin () const { return cbegin(); }
+	const_iterator end () const { return cend(); }
+	const_iterator cbegin () const { containers(); return const_iterator (frontPosition, constIteratorContainer); }
+	const_iterator cend () const { containers(); return const_iterator (frontPosition + count, constIteratorContainer); }
+};
+
+#pragma region RingVector implementation
+
+template <typename T>
+RingVector<T>::RingVector () : buffer(nullptr), ringCapacity(0), head(0), count(0), frontPosition(0) {
+	#ifdef DEBUG_MODE
+	std::cerr << "RingVector()" << std::endl;
+	#endif
+
+	initContainers();
+
+	#ifdef MEMORY_TRACE_MODE
+	watcher.onVectorDefCreated ();
+	#endif
+}
+
+template <typename T>
+RingVector<T>::RingVector (const StorageOptions &options)
+	: buffer(nullptr), ringCapacity(0), head(0), count(0), frontPosition(0), storageOptions(options) {
+	#ifdef DEBUG_MODE
+	std::cerr << "RingVector(StorageOptions)" << std::endl;
+	#endif
+
+	initContainers();
+
+	#ifdef MEMORY_TRACE_MODE
+	watcher.onVectorDefCreated ();
+	#endif
+}
+
+template <typename T>
+RingVector<T>::RingVector (const RingVector<T> &other)
+	: buffer(nullptr), ringCapacity(0), head(0), count(0), frontPosition(0), storageOptions(other.storageOptions) {
+	#ifdef DEBUG_MODE
+	std::cerr << "RingVector(const &)" << std::endl;
+	#endif
+
+	initContainers();
+
+	VECTOR_TRY {
+		reserve (other.count);
+		for (size_t i = 0; i < other.count; ++i) {
+			new(buffer + i) T(other.buffer[other.slot(i)]);
+			++count;
+		}
+	}
+	VECTOR_CATCH_ALL {
+		destroyElements();
+		releaseBuffer();
+		delete iteratorContainer;
+		delete constIteratorContainer;
+		VECTOR_RETHROW;
+	}
+
+	#ifdef MEMORY_TRACE_MODE
+	watcher.onVectorCopyCreated ();
+	#endif
+}
+
+template <typename T>
+RingVector<T>::RingVector (RingVector<T> &&other) noexcept
+	: buffer(other.buffer), ringCapacity(other.ringCapacity), head(other.head), count(other.count),
+	frontPosition(other.frontPosition), storageOptions(other.storageOptions) {
+	#ifdef DEBUG_MODE
+	std::cerr << "RingVector(&&)" << std::endl;
+	#endif
+
+	iteratorContainer = other.iteratorContainer;
+	constIteratorContainer = other.constIteratorContainer;
+	if (iteratorContainer) {
+		iteratorContainer->vector = this;
+		constIteratorContainer->vector = this;
+	}
+
+	//the moved-from ring gets containers on its next begin()/end()
+	other.buffer = nullptr;
+	other.ringCapacity = other.head = other.count = other.frontPosition = 0;
+	other.iteratorContainer = nullptr;
+	other.constIteratorContainer = nullptr;
+
+	#ifdef MEMORY_TRACE_MODE
+	watcher.onVectorMoveCreated ();
+	#endif
+}
+
+template <typename T>
+RingVector<T>::~RingVector () noexcept {
+	#ifdef DEBUG_MODE
+	std::cerr << "~RingVector()" << std::endl;
+	#endif
+
+	#ifdef MEMORY_TRACE_MODE
+	watcher.onVectorDestroyed ();
+	#endif
+
+	invalidateIterators();
+
+	destroyElements();
+	releaseBuffer();
+}
+
+template <typename T>
+RingVector<T>& RingVector<T>::operator= (const RingVector<T> &other) {
+	RingVector<T> temp(other);
+	this->swap(temp);
+	return *this;
+}
+
+template <typename T>
+RingVector<T>& RingVector<T>::operator= (RingVector<T> &&other) noexcept {
+	RingVector<T> temp(std::move(other));
+	this->swap(temp);
+	return *this;
+}
+
+template <typename T>
+void RingVector<T>::swap (RingVector<T> &other) noexcept {
+	this->invalidateIterators();
+	other.invalidateIterators();
+
+	std::swap (buffer, other.buffer);
+	std::swap (ringCapacity, other.ringCapacity);
+	std::swap (head, other.head);
+	std::swap (count, other.count);
+	std::swap (frontPosition, other.frontPosition);
+	std::swap (storageOptions, other.storageOptions);
+}
+
+template <typename T>
+void RingVector<T>::reserve (size_t new_capacity) {
+	if (new_capacity <= ringCapacity) {
+		return;
+	}
+
+	size_t rounded = ringCapacity ? ringCapacity * 2 : RING_MIN_CAPACITY;
+	while (rounded < new_capacity) {
+		if (rounded > (static_cast<size_t>(-1) / sizeof(T)) / 2) {
+			VECTOR_THROW(std::runtime_error("too large capacity"));
+		}
+		rounded *= 2;
+	}
+
+	reallocate (rounded);
+}
+
+template <typename T>
+void RingVector<T>::reallocate (size_t new_capacity) {
+	invalidateIterators();
+
+	T *newBuffer = relocate (new_capacity, std::integral_constant<bool, std::is_trivially_copyable<T>::value>());
+
+	#ifdef MEMORY_TRACE_MODE
+	watcher.onMemoryAllocated (std::distance (newBuffer, newBuffer + new_capacity));
+	if (buffer) {
+		watcher.onMemoryDeallocated (std::distance (buffer, buffer + ringCapacity));
+	}
+	#endif
+
+	buffer = newBuffer;
+	ringCapacity = new_capacity;
+}
+
+template <typename T>
+T* RingVector<T>::relocate (size_t new_capacity, std::true_type) {
+	size_t wrapped = head + count > ringCapacity ? head + count - ringCapacity : 0;
+
+	T *newBuffer = static_cast<T*>(reallocateStorage (buffer, ringCapacity * sizeof(T), new_capacity * sizeof(T), storageOptions));
+	if (wrapped) {
+		//new_capacity >= 2 * ringCapacity: the wrapped part fits right after the old end
+		memcpy (static_cast<void*>(newBuffer + ringCapacity), newBuffer, wrapped * sizeof(T));
+	}
+
+	return newBuffer;
+}
+
+template <typename T>
+T* RingVector<T>::relocate (size_t new_capacity, std::false_type) {
+	T *newBuffer = static_cast<T*>(allocateStorage (new_capacity * sizeof(T), storageOptions));
+
+	size_t firstRun = head + count > ringCapacity ? ringCapacity - head : count;
+	T *target = newBuffer;
+	for (T *i = buffer + head, *runEnd = buffer + head + firstRun; i < runEnd; ++i, ++target) {
+		new(target) T(std::move(*i));
+		i->~T();
+	}
+	for (T *i = buffer, *runEnd = buffer + (count - firstRun); i < runEnd; ++i, ++target) {
+		new(target) T(std::move(*i));
+		i->~T();
+	}
+
+	if (buffer) {
+		deallocateStorage (buffer, ringCapacity * sizeof(T), storageOptions);
+	}
+	head = 0;
+
+	return newBuffer;
+}
+
+template <typename T>
+void RingVector<T>::clear () noexcept {
+	invalidateIterators();
+
+	destroyElements();
+	head = count = 0;
+}
+
+template <typename T>
+T& RingVector<T>::operator[] (size_t index) {
+	if (index >= count) {
+		VECTOR_THROW(IndexOutOfRangeException ("Index out of range"));
+	}
+	return buffer[slot(index)];
+}
+
+template <typename T>
+const T& RingVector<T>::operator[] (size_t index) const {
+	if (index >= count) {
+		VECTOR_THROW(IndexOutOfRangeException ("Index out of range"));
+	}
+	return buffer[slot(index)];
+}
+
+template <typename T>
+T& RingVector<T>::front () {
+	return (*this)[0];
+}
+
+template <typename T>
+const T& RingVector<T>::front () const {
+	return (*this)[0];
+}
+
+template <typename T>
+T& RingVector<T>::back () {
+	return (*this)[count - 1];
+}
+
+template <typename T>
+const T& RingVector<T>::back () const {
+	return (*this)[count - 1];
+}
+
+template <typename T>
+void RingVector<T>::push_back (const T &value) {
+	if (count == ringCapacity) {
+		T copy(value); //value may live in this ring
+		push_back (std::move(copy));
+		return;
+	}
+
+	new(buffer + slot(count)) T(value);
+	++count;
+}
+
+template <typename T>
+void RingVector<T>::push_back (T &&value) {
+	if (count == ringCapacity) {
+		reserve (count + 1);
+	}
+
+	new(buffer + slot(count)) T(std::move(value));
+	++count;
+}
+
+template <typename T>
+void RingVector<T>::pop_front () {
+	if (!count) {
+		VECTOR_THROW(InvalidOperationException ("Cannot pop from empty ring"));
+	}
+
+	buffer[head].~T();
+	head = (head + 1) & (ringCapacity - 1);
+	--count;
+	++frontPosition;
+}
+
+template <typename T>
+void RingVector<T>::pop_back () {
+	if (!count) {
+		VECTOR_THROW(InvalidOperationException ("Cannot pop from empty ring"));
+	}
+
+	buffer[slot(count - 1)].~T();
+	--count;
+}
+
+#pragma endregion
+
+#pragma region RingIterator implementation
+
+template <typename T>
+RingIterator<T>::RingIterator (size_t position, Container *container) : position(position), container(container) {
+	prev = next = nullptr;
+	container->addIterator (this);
+
+	#ifdef MEMORY_TRACE_MODE
+	watcher.onBaseIteratorPtrCreated();
+	#endif
+}
+
+template <typename T>
+RingIterator<T>::RingIterator () : position(0), container(nullptr) {
+	prev = next = nullptr;
+
+	#ifdef MEMORY_TRACE_MODE
+	watcher.onBaseIteratorDefCreated();
+	#endif
+}
+
+template <typename T>
+RingIterator<T>::RingIterator (const RingIterator<T> &iter) : position(iter.position), container(iter.container) {
+	prev = next = nullptr;
+	if (container) {
+		container->addIterator (this);
+	}
+
+	#ifdef MEMORY_TRACE_MODE
+	watcher.onBaseIteratorCopyCreated();
+	#endif
+}
+
+template <typename T>
+RingIterator<T>::~RingIterator () {
+	selfRemoveFromContainer();
+
+	#ifdef MEMORY_TRACE_MODE
+	watcher.onBaseIteratorDestroyed();
+	#endif
+}
+
+template <typename T>
+void RingIterator<T>::selfRemoveFromContainer () {
+	if (prev) {
+		prev->next = next;
+	}
+	if (next) {
+		next->prev = prev;
+	}
+	if (!prev && container) {
+		container->headIterator = next;
+	}
+
+	prev = next = nullptr;
+
+	//killing container if the ring is dead and no iterators left
+	if (container && container->isVectorDestroyed() && !container->headIterator) {
+		delete container;
+	}
+	container = nullptr;
+}
+
+template <typename T>
+RingIterator<T>& RingIterator<T>::operator= (const RingIterator<T> &iter) {
+	position = iter.position;
+
+	if (container != iter.container) {
+		selfRemoveFromContainer();
+
+		container = iter.container;
+		if (container) {
+			container->addIterator (this);
+		}
+	}
+
+	return *this;
+}
+
+template <typename T>
+RingIterator<T>::operator RingIterator<const ValueType> () const {
+	if (container && container->vector) {
+		return RingIterator<const ValueType> (position, container->vector->constIteratorContainer);
+	}
+	return RingIterator<const ValueType> ();
+}
+
+template <typename T>
+T& RingIterator<T>::operator[] (ptrdiff_t offset) const {
+	checkValidity();
+
+	const Ring *ring = container->vector;
+	size_t target = position + offset;
+	size_t index = target - ring->frontPosition;
+
+	if (index < ring->count) {
+		return *ring->elementAt(target);
+	}
+	if (index == ring->count || position - ring->frontPosition > ring->count) { //points to the end or to a popped element
+		VECTOR_THROW(IteratorOutOfRangeException());
+	}
+	VECTOR_THROW(InvalidIteratorShiftException());
+}
+
+template <typename T>
+RingIterator<T>& RingIterator<T>::operator+= (ptrdiff_t offset) {
+	checkValidity();
+
+	const Ring *ring = container->vector;
+	size_t index = position + offset - ring->frontPosition;
+
+	if (index > ring->count) { //before the front (wraps to a huge number) or past the end
+		VECTOR_THROW(InvalidIteratorShiftException());
+	}
+	position += offset;
+	return *this;
+}
+
+#pragma endregion
@@ -0,0 +1,359 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include "Vector.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SHARED_VECTOR_POSIX
+#endif
+
+#if defined(_MSC_FULL_VER) && _MSC_FULL_VER < 180000000
+#define noexcept throw()
+#endif
+
+struct SharedVectorException : public std::exception {
+	std::string message;
+
+	explicit SharedVectorException (const std::string &msg) : message(msg) { }
+
+	const char* what () const noexcept override {
+		return message.c_str();
+	}
+};
+
+#ifdef SHARED_VECTOR_POSIX
+
+namespace shared_detail {
+	const uint64_t MAGIC = 0x5643455653485244ULL; //"DRHSVECV"
+
+	static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "SharedVector needs lock-free 64-bit atomics to share them between processes");
+
+	//Start of the shared region. Holds no pointers: the elements are found at dataOffset from the start
+	//of the region, whatever address each process maps it at.
+	struct Header {
+		uint64_t magic;
+		uint64_t elementSize;
+		uint64_t capacity;
+		uint64_t dataOffset;
+		uint64_t consumers;
+		std::atomic<uint64_t> sequence;		//2 * published batches, odd while the producer writes a batch
+		std::atomic<uint64_t> size;			//elements in the last published batch
+		std::atomic<uint64_t> acknowledged;	//consumers done with the last published batch
+	};
+
+	inline size_t dataOffset (size_t alignment) noexcept {
+		return (sizeof(Header) + alignment - 1) / alignment * alignment;
+	}
+}
+
+///<summary>
+///Vector of trivially copyable elements in a shared memory region (named POSIX shared memory or a memfd),
+///for passing batches between processes without copying or serializing them.
+///The capacity is fixed when the region is created.
+///Handoff protocol, one producer and a fixed number of consumers:
+///	producer: begin_batch() (waits until every consumer acknowledged the previous batch), push_back..., publish()
+///	consumer: wait_batch(last) (waits for a batch newer than 'last'), reads data()/size()/[], acknowledge()
+///</summary>
+template <typename T>
+class SharedVector {
+private:
+	static_assert(std::is_trivially_copyable<T>::value, "SharedVector elements are shared as raw bytes: T must be trivially copyable");
+
+	int fd;
+	void *region;
+	size_t regionBytes;
+	size_t count;		//producer: elements of the open batch, consumer: elements of the received batch
+	bool writing;		//producer has an open batch
+
+	#if defined(_MSC_FULL_VER) && _MSC_FULL_VER < 180000000
+	SharedVector (const SharedVector<T> &);
+	SharedVector<T>& operator= (const SharedVector<T> &);
+	#else
+	SharedVector (const SharedVector<T> &) = delete;
+	SharedVector<T>& operator= (const SharedVector<T> &) = delete;
+	#endif
+
+	SharedVector () noexcept : fd(-1), region(nullptr), regionBytes(0), count(0), writing(false) { }
+
+	shared_detail::Header* header () const noexcept {
+		return static_cast<shared_detail::Header*>(region);
+	}
+
+	T* elements () const noexcept {
+		return reinterpret_cast<T*>(static_cast<char*>(region) + header()->dataOffset);
+	}
+
+	static size_t bytesFor (size_t capacity) noexcept {
+		return shared_detail::dataOffset(alignof(T)) + capacity * sizeof(T);
+	}
+
+	void map (size_t bytes) {
+		regionBytes = bytes;
+		region = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (region == MAP_FAILED) {
+			region = nullptr;
+			VECTOR_THROW(SharedVectorException ("Cannot map shared memory"));
+		}
+	}
+
+	//sizes and maps a fresh region, writes the header
+	void initialize (size_t capacity, size_t consumers) {
+		if (ftruncate(fd, static_cast<off_t>(bytesFor(capacity))) != 0) {
+			VECTOR_THROW(SharedVectorException ("Cannot size shared memory"));
+		}
+		map(bytesFor(capacity));
+
+		shared_detail::Header *h = header();
+		h->elementSize = sizeof(T);
+		h->capacity = capacity;
+		h->dataOffset = shared_detail::dataOffset(alignof(T));
+		h->consumers = consumers;
+		new(&h->sequence) std::atomic<uint64_t>(0);
+		new(&h->size) std::atomic<uint64_t>(0);
+		new(&h->acknowledged) std::atomic<uint64_t>(0);
+		std::atomic_thread_fence(std::memory_order_release);
+		h->magic = shared_detail::MAGIC;
+	}
+
+	void release () noexcept {
+		if (region) {
+			munmap(region, regionBytes);
+		}
+		if (fd >= 0) {
+			close(fd);
+		}
+		region = nullptr;
+		fd = -1;
+	}
+
+	//waits until 'ready()' or the timeout (0: no timeout) runs out
+	template <typename Condition>
+	static bool waitFor (const Condition &ready, unsigned timeoutMs) {
+		std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+		for (unsigned spins = 0; !ready(); ++spins) {
+			if (timeoutMs && std::chrono::steady_clock::now() >= deadline) {
+				return false;
+			}
+			if (spins < 64) {
+				std::this_thread::yield();
+			}
+			else {
+				std::this_thread::sleep_for(std::chrono::microseconds(50));
+			}
+		}
+		return true;
+	}
+
+public:
+	typedef T value_type;
+
+	SharedVector (SharedVector<T> &&other) noexcept
+		: fd(other.fd), region(other.region), regionBytes(other.regionBytes), count(other.count), writing(other.writing) {
+		other.fd = -1;
+		other.region = nullptr;
+	}
+
+	SharedVector<T>& operator= (SharedVector<T> &&other) noexcept {
+		if (this != &other) {
+			release();
+			fd = other.fd;
+			region = other.region;
+			regionBytes = other.regionBytes;
+			count = other.count;
+			writing = other.writing;
+			other.fd = -1;
+			other.region = nullptr;
+		}
+		return *this;
+	}
+
+	~SharedVector () noexcept {
+		release();
+	}
+
+	//creates the named region (shm_open, "/name"); it must not exist yet
+	static SharedVector<T> create (const std::string &name, size_t capacity, size_t consumers) {
+		SharedVector<T> v;
+		v.fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+		if (v.fd < 0) {
+			VECTOR_THROW(SharedVectorException ("Cannot create shared memory " + name));
+		}
+		v.initialize(capacity, consumers);
+		return v;
+	}
+
+	//maps a region made by create() in this or another process
+	static SharedVector<T> open (const std::string &name) {
+		SharedVector<T> v;
+		v.fd = shm_open(name.c_str(), O_RDWR, 0600);
+		if (v.fd < 0) {
+			VECTOR_THROW(SharedVectorException ("Cannot open shared memory " + name));
+		}
+
+		struct stat info;
+		if (fstat(v.fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(shared_detail::Header)) {
+			VECTOR_THROW(SharedVectorException ("Shared memory " + name + " is not a SharedVector"));
+		}
+		v.map(static_cast<size_t>(info.st_size));
+
+		shared_detail::Header *h = v.header();
+		if (h->magic != shared_detail::MAGIC || h->elementSize != sizeof(T) || bytesFor(static_cast<size_t>(h->capacity)) > v.regionBytes) {
+			VECTOR_THROW(SharedVectorException ("Shared memory " + name + " holds other elements"));
+		}
+		return v;
+	}
+
+	//removes the name; mappings stay valid until they are closed
+	static void unlink (const std::string &name) noexcept {
+		shm_unlink(name.c_str());
+	}
+
+	//unnamed region (memfd on Linux, see file_descriptor()), shared with the processes forked after its creation
+	static SharedVector<T> anonymous (size_t capacity, size_t consumers) {
+		SharedVector<T> v;
+		#if defined(__linux__) && defined(MFD_CLOEXEC)
+		v.fd = memfd_create("SharedVector", MFD_CLOEXEC);
+		if (v.fd < 0) {
+			VECTOR_THROW(SharedVectorException ("Cannot create memfd"));
+		}
+		v.initialize(capacity, consumers);
+		#else
+		std::string name = "/SharedVector." + std::to_string(getpid()) + "." + std::to_string(reinterpret_cast<uintptr_t>(&v));
+		v.fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+		if (v.fd < 0) {
+			VECTOR_THROW(SharedVectorException ("Cannot create shared memory " + name));
+		}
+		shm_unlink(name.c_str());
+		v.initialize(capacity, consumers);
+		#endif
+		return v;
+	}
+
+	//descriptor of the region, e.g. to pass a memfd to another process
+	int file_descriptor () const noexcept { return fd; }
+
+	size_t capacity () const noexcept { return static_cast<size_t>(header()->capacity); }
+	size_t size () const noexcept { return count; }
+	bool empty () const noexcept { return count == 0; }
+
+	const T* data () const noexcept { return elements(); }
+
+	const T& operator[] (size_t index) const {
+		if (index >= count) {
+			VECTOR_THROW(IndexOutOfRangeException ("Index out of range"));
+		}
+		return elements()[index];
+	}
+
+	#pragma region producer
+
+	//opens a new batch: waits until every consumer acknowledged the previous one. False on timeout.
+	bool begin_batch (unsigned timeoutMs = 0) {
+		shared_detail::Header *h = header();
+		uint64_t sequence = h->sequence.load(std::memory_order_relaxed);
+		if (writing) {
+			VECTOR_THROW(InvalidOperationException ("Batch is already open"));
+		}
+
+		if (sequence > 0 && !waitFor([h]() { return h->acknowledged.load(std::memory_order_acquire) >= h->consumers; }, timeoutMs)) {
+			return false;
+		}
+
+		h->sequence.store(sequence + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		count = 0;
+		writing = true;
+		return true;
+	}
+
+	void push_back (const T &value) {
+		if (!writing) {
+			VECTOR_THROW(InvalidOperationException ("No open batch: call begin_batch() first"));
+		}
+		if (count == capacity()) {
+			VECTOR_THROW(InvalidOperationException ("SharedVector is full"));
+		}
+		elements()[count++] = value;
+	}
+
+	//writable elements of the open batch
+	T* batch_data () {
+		if (!writing) {
+			VECTOR_THROW(InvalidOperationException ("No open batch: call begin_batch() first"));
+		}
+		return elements();
+	}
+
+	//grows the open batch to 'new_size' elements written through batch_data()
+	void resize_batch (size_t new_size) {
+		if (!writing) {
+			VECTOR_THROW(InvalidOperationException ("No open batch: call begin_batch() first"));
+		}
+		if (new_size > capacity()) {
+			VECTOR_THROW(InvalidOperationException ("SharedVector is full"));
+		}
+		count = new_size;
+	}
+
+	//makes the open batch visible to the consumers, returns its number (1, 2, ...)
+	uint64_t publish () {
+		if (!writing) {
+			VECTOR_THROW(InvalidOperationException ("No open batch: call begin_batch() first"));
+		}
+
+		shared_detail::Header *h = header();
+		uint64_t sequence = h->sequence.load(std::memory_order_relaxed) + 1;
+		h->size.store(count, std::memory_order_relaxed);
+		h->acknowledged.store(0, std::memory_order_relaxed);
+		h->sequence.store(sequence, std::memory_order_release);
+		writing = false;
+		return sequence / 2;
+	}
+
+	#pragma endregion
+
+	#pragma region consumer
+
+	//waits for a batch newer than 'last' (0 before the first one), returns its number, 0 on timeout.
+	//The batch is then data()/size() until acknowledge().
+	uint64_t wait_batch (uint64_t last, unsigned timeoutMs = 0) {
+		shared_detail::Header *h = header();
+		uint64_t sequence = 0;
+		bool ready = waitFor([h, last, &sequence]() {
+			sequence = h->sequence.load(std::memory_order_acquire);
+			return sequence % 2 == 0 && sequence / 2 > last;
+		}, timeoutMs);
+		if (!ready) {
+			return 0;
+		}
+
+		count = static_cast<size_t>(h->size.load(std::memory_order_relaxed));
+		return sequence / 2;
+	}
+
+	//this consumer is done with the received batch, the producer may overwrite it
+	void acknowledge () {
+		count = 0;
+		header()->acknowledged.fetch_add(1, std::memory_order_release);
+	}
+
+	#pragma endregion
+
+	//the received or written elements as a Vector
+	Vector<T> to_vector () const {
+		return Vector<T> (elements(), elements() + count);
+	}
+};
+
+#endif
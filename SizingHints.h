@@ -0,0 +1,190 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "VectorConfig.h"
+
+#if defined(_MSC_FULL_VER) && _MSC_FULL_VER < 180000000
+#define noexcept throw()
+#endif
+
+///<summary>
+///Remembers final sizes of the vectors created with it and predicts the capacity to reserve for the next one.
+///Sizes are kept in a histogram of power-of-two buckets whose weights decay with every new sample,
+///the prediction is the largest size seen in the bucket holding the given percentile of the recent samples.
+///A vector that never had to grow past its predicted capacity is a hit, the others are misses.
+///Thread safe.
+///</summary>
+class SizingHint {
+private:
+	static const int BUCKETS = 64;
+
+	double weights[BUCKETS];	//decayed sample count per bucket
+	size_t maxSizes[BUCKETS];	//largest size recorded in the bucket since it was last empty
+	double totalWeight;
+
+	double decay;		//weight multiplier applied to older samples on every record
+	double percentile;	//share of recent samples the prediction must cover
+
+	size_t hitCount;
+	size_t missCount;
+
+	mutable std::mutex mutex;
+
+	#if defined(_MSC_FULL_VER) && _MSC_FULL_VER < 180000000
+	SizingHint (const SizingHint &);
+	SizingHint& operator= (const SizingHint &);
+	#else
+	SizingHint (const SizingHint &) = delete;
+	SizingHint& operator= (const SizingHint &) = delete;
+	#endif
+
+	static int bucketOf (size_t size) noexcept {
+		int bucket = 0;
+		while (size > 1 && bucket < BUCKETS - 1) {
+			size >>= 1;
+			++bucket;
+		}
+		return bucket;
+	}
+
+	void recordLocked (size_t finalSize, size_t predicted) noexcept {
+		if (finalSize <= predicted) {
+			++hitCount;
+		}
+		else {
+			++missCount;
+		}
+
+		totalWeight = 0;
+		for (int i = 0; i < BUCKETS; ++i) {
+			weights[i] *= decay;
+			if (weights[i] < 1e-3) { //bucket is forgotten
+				weights[i] = 0;
+				maxSizes[i] = 0;
+			}
+			totalWeight += weights[i];
+		}
+
+		int bucket = bucketOf(finalSize);
+		weights[bucket] += 1;
+		totalWeight += 1;
+		if (finalSize > maxSizes[bucket]) {
+			maxSizes[bucket] = finalSize;
+		}
+	}
+
+public:
+	explicit SizingHint (double decay = 0.95, double percentile = 0.9)
+		: totalWeight(0), decay(decay), percentile(percentile), hitCount(0), missCount(0) {
+		for (int i = 0; i < BUCKETS; ++i) {
+			weights[i] = 0;
+			maxSizes[i] = 0;
+		}
+	}
+
+	//capacity to reserve for a new vector, 0 when nothing is known yet
+	size_t predict () const {
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if (totalWeight <= 0) {
+			return 0;
+		}
+
+		double covered = 0;
+		for (int i = 0; i < BUCKETS; ++i) {
+			covered += weights[i];
+			if (covered >= percentile * totalWeight) {
+				return maxSizes[i];
+			}
+		}
+		return maxSizes[BUCKETS - 1];
+	}
+
+	//'finalSize' is the size the vector ended with, 'predicted' - the capacity reserved for it from predict().
+	//Called from ~Vector, so it never throws: a sample that cannot take the lock is dropped.
+	//An empty vector with no prediction tells nothing and is not counted.
+	void record (size_t finalSize, size_t predicted) noexcept {
+		if (finalSize == 0 && predicted == 0) {
+			return;
+		}
+
+		VECTOR_TRY {
+			std::lock_guard<std::mutex> lock(mutex);
+			recordLocked(finalSize, predicted);
+		}
+		VECTOR_CATCH_ALL { }
+	}
+
+	size_t hits () const {
+		std::lock_guard<std::mutex> lock(mutex);
+		return hitCount;
+	}
+
+	size_t misses () const {
+		std::lock_guard<std::mutex> lock(mutex);
+		return missCount;
+	}
+};
+
+///<summary>
+///Process-wide set of SizingHints keyed by a user tag or a call site (see VECTOR_CALL_SITE_HINT).
+///Hints live as long as the process.
+///</summary>
+class SizingHintRegistry {
+private:
+	std::map<std::string, std::unique_ptr<SizingHint>> hints;
+	mutable std::mutex mutex;
+
+	SizingHintRegistry () { }
+
+public:
+	static SizingHintRegistry& instance () {
+		static SizingHintRegistry registry;
+		return registry;
+	}
+
+	//the hint for 'tag', created on first use
+	SizingHint& hint (const std::string &tag) {
+		std::lock_guard<std::mutex> lock(mutex);
+
+		std::unique_ptr<SizingHint> &hint = hints[tag];
+		if (!hint) {
+			hint.reset(new SizingHint());
+		}
+		return *hint;
+	}
+
+	size_t totalHits () const {
+		std::lock_guard<std::mutex> lock(mutex);
+
+		size_t total = 0;
+		for (std::map<std::string, std::unique_ptr<SizingHint>>::const_iterator i = hints.begin(); i != hints.end(); ++i) {
+			total += i->second->hits();
+		}
+		return total;
+	}
+
+	size_t totalMisses () const {
+		std::lock_guard<std::mutex> lock(mutex);
+
+		size_t total = 0;
+		for (std::map<std::string, std::unique_ptr<SizingHint>>::const_iterator i = hints.begin(); i != hints.end(); ++i) {
+			total += i->second->misses();
+		}
+		return total;
+	}
+};
+
+#define VECTOR_HINT_STRINGIFY_IMPL(x) #x
+#define VECTOR_HINT_STRINGIFY(x) VECTOR_HINT_STRINGIFY_IMPL(x)
+
+//SizingHint& of the current source line, looked up in the registry only once
+#define VECTOR_CALL_SITE_HINT() \
+	([]() -> SizingHint& { \
+		static SizingHint &hint = SizingHintRegistry::instance().hint(__FILE__ ":" VECTOR_HINT_STRINGIFY(__LINE__)); \
+		return hint; \
+	}())
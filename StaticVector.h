@@ -0,0 +1,413 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "Vector.h"
+
+#ifdef MEMORY_TRACE_MODE
+#include "MemoryWatcher.h"
+#endif
+
+#if defined(_MSC_FULL_VER) && _MSC_FULL_VER < 180000000
+#define noexcept throw()
+#endif
+
+#ifdef DEBUG_MODE
+#include <iostream>
+#endif
+
+//What StaticVector::push_back does when the vector is full.
+//overflow() is called instead of adding the element, push_back returns its result.
+namespace static_overflow {
+	//throws InvalidOperationException
+	struct Throw {
+		static bool overflow () {
+			VECTOR_THROW(InvalidOperationException ("StaticVector is full"));
+		}
+	};
+
+	//assert in debug builds, the element is dropped in release builds
+	struct Assert {
+		static bool overflow () noexcept {
+			assert(!"StaticVector is full");
+			return false;
+		}
+	};
+
+	//the element is dropped, push_back returns false
+	struct ReturnFalse {
+		static bool overflow () noexcept {
+			return false;
+		}
+	};
+}
+
+template <typename T, size_t N, typename OverflowPolicy = static_overflow::Throw>
+class StaticVector;
+
+template <typename V>
+class StaticIterator;
+
+template <typename V>
+class ConstStaticIterator : public BaseIterator<const typename V::value_type, ConstStaticIterator<V>, V> {
+private:
+	typedef BaseIterator<const typename V::value_type, ConstStaticIterator<V>, V> Base;
+
+	friend V;
+	friend class StaticIterator<V>;
+
+	ConstStaticIterator (const typename V::value_type *ptr, IteratorContainer<ConstStaticIterator<V>, V> *container) : Base(ptr, container) { }
+
+public:
+	ConstStaticIterator (const StaticIterator<V> &iter) : Base(iter) { }
+
+	ConstStaticIterator () { }
+	ConstStaticIterator (const Base &iter) : Base(iter) { }
+};
+
+template <typename V>
+class StaticIterator : public BaseIterator<typename V::value_type, StaticIterator<V>, V> {
+private:
+	typedef BaseIterator<typename V::value_type, StaticIterator<V>, V> Base;
+
+	friend V;
+	friend class ConstStaticIterator<V>;
+
+	StaticIterator (typename V::value_type *ptr, IteratorContainer<StaticIterator<V>, V> *container) : Base(ptr, container) { }
+
+public:
+	StaticIterator () { }
+	StaticIterator (const Base &iter) : Base(iter) { }
+
+	operator BaseIterator<const typename V::value_type, ConstStaticIterator<V>, V> () const {
+		if (this->isValid()) {
+			return ConstStaticIterator<V>(this->dataPointer(), &this->iterContainer()->vector->constIteratorContainer);
+		}
+		else {
+			return ConstStaticIterator<V>();
+		}
+	}
+};
+
+///<summary>
+///Vector of at most N elements stored inside the object: it never touches the allocator.
+///Iterators are checked like Vector's. Their IteratorContainers are members of the vector too,
+///so when the vector dies, the iterators are detached from them and become invalid.
+///Elements never move, so iterators stay valid for the whole life of the vector
+///(an iterator past the new end throws on access, as with Vector).
+///</summary>
+template <typename T, size_t N, typename OverflowPolicy>
+class StaticVector {
+private:
+	static_assert(N > 0, "StaticVector needs a positive capacity");
+
+	alignas(T) unsigned char storage[N * sizeof(T)];
+	size_t count;
+
+	IteratorContainer<StaticIterator<StaticVector>, StaticVector> iteratorContainer;
+	IteratorContainer<ConstStaticIterator<StaticVector>, StaticVector> constIteratorContainer;
+
+	template <typename T1, typename IteratorImpl, typename V>
+	friend class BaseIterator;
+
+	friend class StaticIterator<StaticVector>;
+
+	template <typename IteratorImpl, typename V>
+	friend class IteratorContainer;
+
+	T* elements () noexcept { return reinterpret_cast<T*>(storage); }
+	const T* elements () const noexcept { return reinterpret_cast<const T*>(storage); }
+
+	//for BaseIterator
+	const T *getDataEnd () const {
+		return elements() + count;
+	}
+
+	//for BaseIterator
+	const T *getDataBegin () const {
+		return elements();
+	}
+
+	void destroyElements () noexcept {
+		vector_detail::destroyRange (elements(), elements() + count);
+		count = 0;
+	}
+
+	//move-constructs the elements of 'other' into this empty vector and destroys them in 'other'
+	void moveElementsFrom (StaticVector &other, std::true_type) noexcept {
+		for (; count < other.count; ++count) {
+			new(elements() + count) T(std::move(other.elements()[count]));
+		}
+		other.destroyElements();
+	}
+
+	void moveElementsFrom (StaticVector &other, std::false_type) {
+		VECTOR_TRY {
+			for (; count < other.count; ++count) {
+				new(elements() + count) T(std::move(other.elements()[count]));
+			}
+		}
+		VECTOR_CATCH_ALL {
+			destroyElements();
+			VECTOR_RETHROW;
+		}
+		other.destroyElements();
+	}
+
+public:
+	typedef T value_type;
+	typedef StaticIterator<StaticVector> iterator;
+	typedef ConstStaticIterator<StaticVector> const_iterator;
+	typedef std::reverse_iterator<iterator> reverse_iterator;
+	typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+	typedef InvalidOperationException invalid_operation_exception;
+	typedef IndexOutOfRangeException index_out_of_range_exception;
+
+	StaticVector ();
+
+	//elements past the capacity are handed to the overflow policy
+	template <typename InputIterator>
+	StaticVector (InputIterator begin, InputIterator end);
+
+	StaticVector (const StaticVector &other);
+	StaticVector (StaticVector &&other) noexcept(std::is_nothrow_move_constructible<T>::value);
+	~StaticVector () noexcept;
+
+	StaticVector& operator= (const StaticVector &other);
+	StaticVector& operator= (StaticVector &&other) noexcept(std::is_nothrow_move_constructible<T>::value);
+
+	bool operator== (const StaticVector &other) const;
+	bool operator!= (const StaticVector &other) const { return !(*this == other); }
+
+	//swaps the elements, iterators keep pointing into their own vector
+	void swap (StaticVector &other);
+
+	bool empty () const noexcept { return count == 0; }
+	bool full () const noexcept { return count == N; }
+	size_t size () const noexcept { return count; }
+	static size_t max_size () noexcept { return N; }
+	static size_t capacity () noexcept { return N; }
+
+	//nothing to allocate: only checks that new_capacity fits
+	void reserve (size_t new_capacity) const;
+	void clear () noexcept { destroyElements(); }
+
+	T& operator[] (size_t index);
+	const T& operator[] (size_t index) const;
+
+	T* data () noexcept { return elements(); }
+	const T* data () const noexcept { return elements(); }
+
+	//false if the vector was full (unless the policy threw)
+	bool push_back (const T &value);
+	bool push_back (T &&value);
+	void pop_back ();
+
+	iterator begin () { return iterator (elements(), &iteratorContainer); }
+	iterator end () { return iterator (elements() + count, &iteratorContainer); }
+	const_iterator begin () const { return cbegin(); }
+	const_iterator end () const { return cend(); }
+	const_iterator cbegin () const {
+		return const_iterator (elements(), const_cast<IteratorContainer<const_iterator, StaticVector>*>(&constIteratorContainer));
+	}
+	const_iterator cend () const {
+		return const_iterator (elements() + count, const_cast<IteratorContainer<const_iterator, StaticVector>*>(&constIteratorContainer));
+	}
+
+	reverse_iterator rbegin () { return reverse_iterator (end()); }
+	reverse_iterator rend () { return reverse_iterator (begin()); }
+	const_reverse_iterator rbegin () const { return const_reverse_iterator (end()); }
+	const_reverse_iterator rend () const { return const_reverse_iterator (begin()); }
+};
+
+#pragma region StaticVector implementation
+
+template <typename T, size_t N, typename OverflowPolicy>
+StaticVector<T, N, OverflowPolicy>::StaticVector () : count(0), iteratorContainer(this), constIteratorContainer(this) {
+	#ifdef DEBUG_MODE
+	std::cerr << "StaticVector()" << std::endl;
+	#endif
+
+	#ifdef MEMORY_TRACE_MODE
+	watcher.onVectorDefCreated ();
+	#endif
+}
+
+template <typename T, size_t N, typename OverflowPolicy>
+template <typename InputIterator>
+StaticVector<T, N, OverflowPolicy>::StaticVector (InputIterator begin, InputIterator end)
+	: count(0), iteratorContainer(this), constIteratorContainer(this) {
+	#ifdef DEBUG_MODE
+	std::cerr << "StaticVector(InputIterator, InputIterator)" << std::endl;
+	#endif
+
+	VECTOR_TRY {
+		for (InputIterator i = begin; i != end; ++i) {
+			if (!push_back(*i)) {
+				break;
+			}
+		}
+	}
+	VECTOR_CATCH_ALL {
+		destroyElements();
+		VECTOR_RETHROW;
+	}
+
+	#ifdef MEMORY_TRACE_MODE
+	watcher.onVectorIterCreated ();
+	#endif
+}
+
+template <typename T, size_t N, typename OverflowPolicy>
+StaticVector<T, N, OverflowPolicy>::StaticVector (const StaticVector &other)
+	: count(0), iteratorContainer(this), constIteratorContainer(this) {
+	#ifdef DEBUG_MODE
+	std::cerr << "StaticVector(const &)" << std::endl;
+	#endif
+
+	VECTOR_TRY {
+		for (; count < other.count; ++count) {
+			new(elements() + count) T(other.elements()[count]);
+		}
+	}
+	VECTOR_CATCH_ALL {
+		destroyElements();
+		VECTOR_RETHROW;
+	}
+
+	#ifdef MEMORY_TRACE_MODE
+	watcher.onVectorCopyCreated ();
+	#endif
+}
+
+//elements are moved one by one: the storage can not be taken over
+template <typename T, size_t N, typename OverflowPolicy>
+StaticVector<T, N, OverflowPolicy>::StaticVector (StaticVector &&other) noexcept(std::is_nothrow_move_constructible<T>::value)
+	: count(0), iteratorContainer(this), constIteratorContainer(this) {
+	#ifdef DEBUG_MODE
+	std::cerr << "StaticVector(&&)" << std::endl;
+	#endif
+
+	moveElementsFrom (other, std::integral_constant<bool, std::is_nothrow_move_constructible<T>::value>());
+
+	#ifdef MEMORY_TRACE_MODE
+	watcher.onVectorMoveCreated ();
+	#endif
+}
+
+template <typename T, size_t N, typename OverflowPolicy>
+StaticVector<T, N, OverflowPolicy>::~StaticVector () noexcept {
+	#ifdef DEBUG_MODE
+	std::cerr << "~StaticVector()" << std::endl;
+	#endif
+
+	#ifdef MEMORY_TRACE_MODE
+	watcher.onVectorDestroyed ();
+	#endif
+
+	iteratorContainer.detachAll();
+	constIteratorContainer.detachAll();
+
+	destroyElements();
+}
+
+template <typename T, size_t N, typename OverflowPolicy>
+StaticVector<T, N, OverflowPolicy>& StaticVector<T, N, OverflowPolicy>::operator= (const StaticVector &other) {
+	if (this != &other) {
+		StaticVector temp(other);
+		clear();
+		*this = std::move(temp);
+	}
+	return *this;
+}
+
+template <typename T, size_t N, typename OverflowPolicy>
+StaticVector<T, N, OverflowPolicy>& StaticVector<T, N, OverflowPolicy>::operator= (StaticVector &&other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+	if (this != &other) {
+		clear();
+		moveElementsFrom (other, std::integral_constant<bool, std::is_nothrow_move_constructible<T>::value>());
+	}
+	return *this;
+}
+
+template <typename T, size_t N, typename OverflowPolicy>
+bool StaticVector<T, N, OverflowPolicy>::operator== (const StaticVector &other) const {
+	if (count != other.count) {
+		return false;
+	}
+	for (size_t i = 0; i < count; ++i) {
+		if (!(elements()[i] == other.elements()[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+template <typename T, size_t N, typename OverflowPolicy>
+void StaticVector<T, N, OverflowPolicy>::swap (StaticVector &other) {
+	StaticVector temp(std::move(other));
+	other = std::move(*this);
+	*this = std::move(temp);
+}
+
+template <typename T, size_t N, typename OverflowPolicy>
+void StaticVector<T, N, OverflowPolicy>::reserve (size_t new_capacity) const {
+	if (new_capacity > N) {
+		VECTOR_THROW(InvalidOperationException ("StaticVector capacity exceeded"));
+	}
+}
+
+template <typename T, size_t N, typename OverflowPolicy>
+T& StaticVector<T, N, OverflowPolicy>::operator[] (size_t index) {
+	if (index >= count) {
+		VECTOR_THROW(IndexOutOfRangeException ("Index out of range"));
+	}
+	return elements()[index];
+}
+
+template <typename T, size_t N, typename OverflowPolicy>
+const T& StaticVector<T, N, OverflowPolicy>::operator[] (size_t index) const {
+	if (index >= count) {
+		VECTOR_THROW(IndexOutOfRangeException ("Index out of range"));
+	}
+	return elements()[index];
+}
+
+template <typename T, size_t N, typename OverflowPolicy>
+bool StaticVector<T, N, OverflowPolicy>::push_back (const T &value) {
+	if (count == N) {
+		return OverflowPolicy::overflow();
+	}
+
+	new(elements() + count) T(value);
+	++count;
+	return true;
+}
+
+template <typename T, size_t N, typename OverflowPolicy>
+bool StaticVector<T, N, OverflowPolicy>::push_back (T &&value) {
+	if (count == N) {
+		return OverflowPolicy::overflow();
+	}
+
+	new(elements() + count) T(std::move(value));
+	++count;
+	return true;
+}
+
+template <typename T, size_t N, typename OverflowPolicy>
+void StaticVector<T, N, OverflowPolicy>::pop_back () {
+	if (!count) {
+		VECTOR_THROW(InvalidOperationException ("Cannot pop from empty vector"));
+	}
+
+	--count;
+	vector_detail::destroyRange (elements() + count, elements() + count + 1);
+}
+
+#pragma endregion
@@ -1,9 +1,16 @@
 #pragma once
 
+#include <algorithm>
+#include <cstring>
 #include <limits>
 #include <stdexcept>
 #include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include "Iterator.h"
+#include "VectorStorage.h"
+#include "SizingHints.h"
 
 #if defined(_MSC_FULL_VER) && _MSC_FULL_VER < 180000000
 #define noexcept throw()
@@ -25,17 +32,204 @@ struct InvalidOperationException : public ExceptionWithMessage {
 	explicit InvalidOperationException (const char* msg) : ExceptionWithMessage (msg) { }
 };
 
-template <typename V, typename IteratorTag>
+//failures reported by the try_* operations of Vector instead of exceptions
+enum class VectorError {
+	none,
+	index_out_of_range,
+	capacity_too_large,
+	out_of_memory
+};
+
+///<summary>
+///Result of a non-throwing Vector operation, like std::expected: a reference to an element or a VectorError.
+///</summary>
+template <typename T>
+class VectorExpected {
+private:
+	T *item;
+	VectorError failure;
+
+public:
+	VectorExpected (T &item) noexcept : item(&item), failure(VectorError::none) { }
+	VectorExpected (VectorError error) noexcept : item(nullptr), failure(error) { }
+
+	bool has_value () const noexcept { return failure == VectorError::none; }
+	explicit operator bool () const noexcept { return has_value(); }
+	VectorError error () const noexcept { return failure; }
+
+	//the element, fails (throws or aborts) if there is an error
+	T& value () const {
+		if (!has_value()) {
+			VECTOR_THROW(InvalidOperationException ("VectorExpected holds an error"));
+		}
+		return *item;
+	}
+
+	//unchecked access
+	T& operator* () const noexcept { return *item; }
+	T* operator-> () const noexcept { return item; }
+};
+
+//result of an operation without a value: success or a VectorError
+template <>
+class VectorExpected<void> {
+private:
+	VectorError failure;
+
+public:
+	VectorExpected () noexcept : failure(VectorError::none) { }
+	VectorExpected (VectorError error) noexcept : failure(error) { }
+
+	bool has_value () const noexcept { return failure == VectorError::none; }
+	explicit operator bool () const noexcept { return has_value(); }
+	VectorError error () const noexcept { return failure; }
+
+	void value () const {
+		if (!has_value()) {
+			VECTOR_THROW(InvalidOperationException ("VectorExpected holds an error"));
+		}
+	}
+};
+
+template <typename T>
+class VectorChunks;
+
+template <typename T>
+class CheckedRange;
+
+class PackedIntVector;
+
+namespace vector_detail {
+	//placement new, std::construct_at in C++20 (usable in constant evaluation)
+	template <typename T, typename... Args>
+	VECTOR_CONSTEXPR void constructAt (T *place, Args&&... args) {
+		#ifdef VECTOR_CXX20
+		std::construct_at (place, std::forward<Args>(args)...);
+		#else
+		new(place) T(std::forward<Args>(args)...);
+		#endif
+	}
+
+	//trivially destructible elements: nothing to do, not even a loop
+	template <typename T>
+	VECTOR_CONSTEXPR void destroyRange (T*, T*, std::true_type) noexcept { }
+
+	template <typename T>
+	VECTOR_CONSTEXPR void destroyRange (T *begin, T *end, std::false_type) noexcept {
+		for (T *i = begin; i < end; ++i) {
+			i->~T();
+		}
+	}
+
+	//destroys the elements of [begin, end)
+	template <typename T>
+	VECTOR_CONSTEXPR void destroyRange (T *begin, T *end) noexcept {
+		destroyRange (begin, end, std::integral_constant<bool, std::is_trivially_destructible<T>::value>());
+	}
+
+	//below this many bytes a parallel fill does not start threads
+	const size_t PARALLEL_FILL_THRESHOLD = 4 * 1024 * 1024;
+
+	//count copies of a trivially copyable value into raw memory:
+	//memset when all bytes of the value are equal (zero, -1...), vectorizable stores otherwise
+	template <typename T>
+	void fillTrivial (T *first, size_t count, const T &value) noexcept {
+		unsigned char bytes[sizeof(T)];
+		memcpy(bytes, &value, sizeof(T));
+
+		bool uniform = true;
+		for (size_t i = 1; i < sizeof(T) && uniform; ++i) {
+			uniform = bytes[i] == bytes[0];
+		}
+
+		if (uniform) {
+			memset(static_cast<void*>(first), bytes[0], count * sizeof(T));
+		}
+		else {
+			std::fill_n(first, count, value);
+		}
+	}
+
+	//The same on 'threads' threads: thread i writes the i-th of 'threads' equal parts, so on first touch
+	//its pages are placed on the NUMA node of that thread.
+	template <typename T>
+	void fillTrivialParallel (T *first, size_t count, const T &value, size_t threads) {
+		if (threads < 2 || count * sizeof(T) < PARALLEL_FILL_THRESHOLD) {
+			fillTrivial(first, count, value);
+			return;
+		}
+
+		std::thread *workers = new std::thread[threads - 1];
+		size_t started = 0;
+		VECTOR_TRY {
+			for (; started < threads - 1; ++started) {
+				size_t begin = count / threads * (started + 1);
+				size_t end = started + 2 == threads ? count : begin + count / threads;
+				workers[started] = std::thread([first, begin, end, &value]() {
+					fillTrivial(first + begin, end - begin, value);
+				});
+			}
+		}
+		VECTOR_CATCH_ALL {
+			for (size_t i = 0; i < started; ++i) {
+				workers[i].join();
+			}
+			delete[] workers;
+			VECTOR_RETHROW;
+		}
+
+		fillTrivial(first, count / threads, value); //the first part on the calling thread
+
+		for (size_t i = 0; i < started; ++i) {
+			workers[i].join();
+		}
+		delete[] workers;
+	}
+}
+
+//size of staging chunks used to read single-pass ranges
+const size_t INPUT_STAGING_CHUNK_BYTES = 64 * 1024;
+
+//Single-pass (input) iterators: the size is unknown, so elements are read into fixed-size staging chunks
+//which are then moved into one allocation of the exact size. Every chunk is freed as soon as it is moved.
+template <typename V, typename IteratorTag, bool MultiPass = std::is_base_of<std::forward_iterator_tag, IteratorTag>::value>
 struct IterCtorSpecializer {
 	template <typename Iterator>
-	void performReserve (V *v, Iterator begin, Iterator end) { }
+	VECTOR_CONSTEXPR void performFill (V *v, Iterator begin, Iterator end) {
+		const size_t chunkSize = INPUT_STAGING_CHUNK_BYTES / sizeof(typename V::value_type) + 1;
+
+		Vector<V> chunks;
+		size_t total = 0;
+
+		for (Iterator i = begin; i != end; ++i, ++total) {
+			if (chunks.empty() || chunks[chunks.size() - 1].size() == chunkSize) {
+				chunks.push_back(V());
+				chunks[chunks.size() - 1].reserve(chunkSize);
+			}
+			chunks[chunks.size() - 1].push_back(*i);
+		}
+
+		v->reserve (total);
+		for (size_t c = 0, count = chunks.size(); c < count; ++c) {
+			V &chunk = chunks[c];
+			for (size_t j = 0, sz = chunk.size(); j < sz; ++j) {
+				v->push_back(std::move(chunk[j]));
+			}
+			chunk.clear();
+		}
+	}
 };
 
-template <typename V>
-struct IterCtorSpecializer <V, std::random_access_iterator_tag> {
+//Multi-pass (forward and stronger) iterators: the exact size is known in advance
+template <typename V, typename IteratorTag>
+struct IterCtorSpecializer <V, IteratorTag, true> {
 	template <typename Iterator>
-	void performReserve (V *v, Iterator begin, Iterator end) {
-		v->reserve (end - begin);
+	VECTOR_CONSTEXPR void performFill (V *v, Iterator begin, Iterator end) {
+		v->reserve (std::distance(begin, end));
+
+		for (Iterator i = begin; i != end; ++i) {
+			v->push_back(*i);
+		}
 	}
 };
 
@@ -46,15 +240,24 @@ private:
 	T* memory_end;
 	T* data_end;
 
-	IteratorContainer<Iterator<T>, Vector<T>> *iteratorContainer; //modifiable iterators
-	IteratorContainer<ConstIterator<T>, Vector<T>> *constIteratorContainer; //const iterators
+	StorageOptions storageOptions; //how the buffer is allocated
+
+	SizingHint *sizingHint; //receives the final size on destruction, may be null
+	size_t predictedCapacity; //capacity reserved from sizingHint
+
+	size_t bufferGeneration; //changes whenever elements may move or be removed, see generation()
+
+	//Made by the constructors; null after a move-out or an invalidation until the next iterator, see containers().
+	//Mutable: a const vector may be made without them, e.g. moved from a vector that had just reallocated.
+	VECTOR_LAZY_MUTABLE IteratorContainer<Iterator<T>, Vector<T>> *iteratorContainer; //modifiable iterators
+	VECTOR_LAZY_MUTABLE IteratorContainer<ConstIterator<T>, Vector<T>> *constIteratorContainer; //const iterators
 
-	size_t getOptimalNewCapacity (size_t new_capacity) const {
+	VECTOR_CONSTEXPR size_t getOptimalNewCapacity (size_t new_capacity) const {
 		if (new_capacity <= capacity()) {
 			return capacity();
 		}
 		if (new_capacity > max_size()) {
-			throw std::runtime_error("too large capacity");
+			VECTOR_THROW(std::runtime_error("too large capacity"));
 		}
 		if (new_capacity < capacity() * 2) {
 			if (capacity() >= max_size() / 2) {
@@ -69,30 +272,86 @@ private:
 	}
 
 	//Safely initializes iteratorContainer and constIteratorContainer
-	void initContainers () {
+	VECTOR_CONSTEXPR void initContainers () {
 		iteratorContainer = new IteratorContainer<iterator, Vector<T>> (this);
-		try {
+		VECTOR_TRY {
 			constIteratorContainer = new IteratorContainer<const_iterator, Vector<T>> (this);
 		}
-		catch (...) { delete iteratorContainer; throw; }
+		VECTOR_CATCH_ALL { delete iteratorContainer; iteratorContainer = nullptr; VECTOR_RETHROW; }
+	}
+
+	//Containers for a new iterator, created if the vector has none. The rule: only the container pointers are written,
+	//and they are mutable (see VECTOR_LAZY_MUTABLE), so begin() of a const vector modifies no const object
+	VECTOR_CONSTEXPR void containers () const {
+		if (!iteratorContainer) {
+			const_cast<Vector<T>*>(this)->initContainers();
+		}
+	}
+
+	//allocates raw memory for 'count' elements according to storageOptions (std::allocator in constant evaluation)
+	VECTOR_CONSTEXPR T* allocate (size_t count) {
+		if (VECTOR_CONSTANT_EVALUATED()) {
+			return std::allocator<T>().allocate(count);
+		}
+		return static_cast<T*>(allocateStorage (count * sizeof(T), storageOptions));
+	}
+
+	//frees memory obtained by allocate(count)
+	VECTOR_CONSTEXPR void deallocate (T *ptr, size_t count) noexcept {
+		if (VECTOR_CONSTANT_EVALUATED()) {
+			if (ptr) {
+				std::allocator<T>().deallocate(ptr, count);
+			}
+			return;
+		}
+		deallocateStorage (ptr, count * sizeof(T), storageOptions);
+	}
+
+	//shared body of both for_each_chunk: 'first' is memory_begin as T* or const T*
+	template <typename Element, typename Function>
+	void forEachChunk (Element *first, Function &fn, size_t chunk, bool prefetch) const;
+
+	//moves the elements into a buffer of exactly new_capacity (>= size(), > 0) elements
+	VECTOR_CONSTEXPR void reallocate (size_t new_capacity);
+
+	//trivially copyable elements: the buffer is resized as raw bytes (realloc)
+	VECTOR_CONSTEXPR T* relocate (size_t new_capacity, std::true_type);
+
+	//other elements are move-constructed one by one
+	VECTOR_CONSTEXPR T* relocate (size_t new_capacity, std::false_type);
+
+	//constructs 'count' copies of 'value' past the last element, capacity must be reserved
+	void appendFill (size_t count, const T &value, size_t threads, std::true_type) {
+		vector_detail::fillTrivialParallel (data_end, count, value, threads);
+		data_end += count;
+	}
+
+	void appendFill (size_t count, const T &value, size_t, std::false_type) {
+		for (size_t i = 0; i < count; ++i) {
+			vector_detail::constructAt (data_end, value);
+			++data_end;
+		}
 	}
 
 	//for BaseIterator
-	const T *getDataEnd () const {
+	VECTOR_CONSTEXPR const T *getDataEnd () const {
 		return data_end;
 	}
 
 	//for BaseIterator
-	const T *getDataBegin () const {
+	VECTOR_CONSTEXPR const T *getDataBegin () const {
 		return memory_begin;
 	}
 
-	//for internal use
-	void invalidateIterators () {
-		iteratorContainer->invalidateAll();
-		constIteratorContainer->invalidateAll();
-
-		initContainers();
+	//for internal use. Does not allocate: the next iterator gets new containers
+	VECTOR_CONSTEXPR void invalidateIterators () noexcept {
+		++bufferGeneration;
+		if (iteratorContainer) {
+			iteratorContainer->invalidateAll();
+			constIteratorContainer->invalidateAll();
+			iteratorContainer = nullptr;
+			constIteratorContainer = nullptr;
+		}
 	}
 
 	template <typename T1, typename IteratorImpl, typename V>
@@ -105,7 +364,25 @@ private:
 	template <typename IteratorImpl, typename V>
 	friend class IteratorContainer;
 
+	template <typename T1>
+	friend class VectorLoader;
+
+	template <typename T1>
+	friend class CheckedRange;
+
+	friend class PackedIntVector;
+
+	//for VectorLoader and PackedIntVector: raw room past the last element (reserve first) and its commit after it was filled
+	T *uninitializedEnd () const {
+		return data_end;
+	}
+
+	void commitAppended (size_t count) {
+		data_end += count;
+	}
+
 public:
+	typedef T value_type;
 	typedef Iterator<T> iterator;
 	typedef ConstIterator<T> const_iterator;
 	typedef std::reverse_iterator<Iterator<T>> reverse_iterator;
@@ -119,68 +396,125 @@ public:
 	typedef InvalidOperationException invalid_operation_exception;
 	typedef IndexOutOfRangeException index_out_of_range_exception;
 
-	Vector ();	//default constructor
-	Vector (const Vector<T> &other);	//copy constructor
-	Vector (Vector<T> &&other) noexcept;	//move constructor
-
-	template <typename InputIterator>
-	Vector (InputIterator begin, InputIterator end);
+	VECTOR_CONSTEXPR Vector ();	//default constructor
+	VECTOR_CONSTEXPR explicit Vector (const StorageOptions &options);	//empty vector with custom storage
+	explicit Vector (SizingHint &hint, const StorageOptions &options = StorageOptions());	//reserves the predicted capacity, see SizingHints.h
+	VECTOR_CONSTEXPR Vector (const Vector<T> &other);	//copy constructor
+	VECTOR_CONSTEXPR Vector (Vector<T> &&other) noexcept;	//move constructor
 
-	~Vector() noexcept;
+	//'count' copies of 'value'. Trivially copyable elements are written with memset or vectorizable stores,
+	//with threads > 1 large buffers are first touched (and so placed on NUMA nodes) by the threads, see assign.
+	Vector (size_t count, const T &value, size_t threads = 1);
 
-	Vector<T>& operator= (const Vector<T> &other); // copy
-	Vector<T>& operator= (Vector<T> &&other) noexcept; // move
+	template <typename InputIterator, typename std::enable_if<!std::is_integral<InputIterator>::value, int>::type = 0>
+	VECTOR_CONSTEXPR Vector (InputIterator begin, InputIterator end);
 
-	bool operator== (const Vector<T> &other) const;
-	bool operator!= (const Vector<T> &other) const { return !(*this == other); }
+	VECTOR_CONSTEXPR ~Vector() noexcept;
 
-	void swap(Vector<T> &other) noexcept; //         O(1)
+	VECTOR_CONSTEXPR Vector<T>& operator= (const Vector<T> &other); // copy
+	VECTOR_CONSTEXPR Vector<T>& operator= (Vector<T> &&other) noexcept; // move
 
-	bool empty() const noexcept { return size() == 0; }
+	VECTOR_CONSTEXPR bool operator== (const Vector<T> &other) const;
+	VECTOR_CONSTEXPR bool operator!= (const Vector<T> &other) const { return !(*this == other); }
 
-	size_t size() const noexcept;
-	size_t max_size() const noexcept; // , ( size_t) / sizeof(T)
-	size_t capacity() const noexcept;
-	void reserve(size_t new_capacity);
-	void shrink_to_fit();
-	void clear() noexcept; //    swap
-
-	T& operator[](size_t index);
-	const T& operator[](size_t index) const;
-
-	void push_back(const T &value);
-	void push_back(T &&value);
-	void pop_back();
+	VECTOR_CONSTEXPR void swap(Vector<T> &other) noexcept; //         O(1)
 
-	//begin/end iterators
+	VECTOR_CONSTEXPR bool empty() const noexcept { return size() == 0; }
 
-	iterator begin() noexcept { return iterator (memory_begin, iteratorContainer); }
-	iterator end() noexcept { return iterator (data_end, iteratorContainer); }
+	VECTOR_CONSTEXPR size_t size() const noexcept;
+	VECTOR_CONSTEXPR size_t max_size() const noexcept; // , ( size_t) / sizeof(T)
+	VECTOR_CONSTEXPR size_t capacity() const noexcept;
+	VECTOR_CONSTEXPR void reserve(size_t new_capacity);
+	void shrink_to_fit();
+	void shrink_to(size_t new_capacity); // capacity becomes max(new_capacity, size()) if that is smaller
+	VECTOR_CONSTEXPR void clear() noexcept; //    swap
+	VECTOR_CONSTEXPR void clear(bool keep_capacity) noexcept; // keep_capacity: only the elements are destroyed, the buffer and iterators stay
+
+	const StorageOptions& storage_options() const noexcept { return storageOptions; }
+	void set_storage_options(const StorageOptions &options); // reallocates the buffer if there is one
+
+	VECTOR_CONSTEXPR T& operator[](size_t index);
+	VECTOR_CONSTEXPR const T& operator[](size_t index) const;
+
+	//raw contiguous storage: [data(), data() + size())
+	VECTOR_CONSTEXPR T* data() noexcept { return memory_begin; }
+	VECTOR_CONSTEXPR const T* data() const noexcept { return memory_begin; }
+
+	VECTOR_CONSTEXPR void push_back(const T &value);
+	VECTOR_CONSTEXPR void push_back(T &&value);
+	VECTOR_CONSTEXPR void pop_back();
+
+	//report capacity and bounds failures as a VectorError instead of throwing.
+	//Out of memory is reported only in builds with exceptions, otherwise it goes to the failure handler.
+	VectorExpected<void> try_reserve(size_t new_capacity);
+	VectorExpected<void> try_push_back(const T &value);
+	VectorExpected<void> try_push_back(T &&value);
+	VectorExpected<T> at_checked(size_t index) noexcept;
+	VectorExpected<const T> at_checked(size_t index) const noexcept;
+
+	//replaces the contents with 'count' copies of 'value'. With threads > 1 a trivially copyable buffer of at least
+	//PARALLEL_FILL_THRESHOLD bytes is split into 'threads' equal parts, each written by its own thread:
+	//a worker which later processes the same part finds its pages on its NUMA node.
+	void assign(size_t count, const T &value, size_t threads = 1);
+
+	//bulk shrink: elements past new_size are destroyed in one pass, capacity and iterators are kept
+	VECTOR_CONSTEXPR void truncate(size_t new_size) noexcept;
+	VECTOR_CONSTEXPR void pop_back_n(size_t count);
+
+	//non-owning views, see VectorView.h. A view dangles after reallocation.
+	VectorView<T> view() { return view(0, size()); }
+	VectorView<T> view(size_t offset, size_t count, size_t step = 1);
+	VectorView<const T> view() const { return view(0, size()); }
+	VectorView<const T> view(size_t offset, size_t count, size_t step = 1) const;
+
+	//chunked traversal, see VectorChunks.h: validated once, then 'fn(T *data, size_t count)' gets raw spans
+	//of at most 'chunk' elements (0: about VECTOR_CHUNK_BYTES), the next chunk is prefetched meanwhile
+	template <typename Function>
+	void for_each_chunk(Function fn, size_t chunk = 0, bool prefetch = true);
+	template <typename Function>
+	void for_each_chunk(Function fn, size_t chunk = 0, bool prefetch = true) const;
+	VectorChunks<T> chunks(size_t chunk = 0, bool prefetch = true);
+	VectorChunks<const T> chunks(size_t chunk = 0, bool prefetch = true) const;
+
+	//validate-once range-for, see CheckedRange.h: the bounds are checked on entry, the loop runs on raw pointers
+	//and throws InvalidOperationException if generation() changes meanwhile
+	CheckedRange<T> checked();
+	CheckedRange<T> checked(size_t offset, size_t count);
+	CheckedRange<const T> checked() const;
+	CheckedRange<const T> checked(size_t offset, size_t count) const;
+
+	//stamp of the buffer and its elements: changes on reallocation, swap, move-out and removal of elements
+	VECTOR_CONSTEXPR size_t generation() const noexcept { return bufferGeneration; }
+
+	//begin/end iterators. The first iterator after a move-out or an invalidation allocates the iterator containers
+
+	VECTOR_CONSTEXPR iterator begin() { containers(); return iterator (memory_begin, iteratorContainer); }
+	VECTOR_CONSTEXPR iterator end() { containers(); return iterator (data_end, iteratorContainer); }
 
 	//begin/end reverse iterators
 
-	reverse_iterator rbegin() noexcept { return reverse_iterator (end()); }
-	reverse_iterator rend() noexcept { return reverse_iterator (begin()); }
+	reverse_iterator rbegin() { return reverse_iterator (end()); }
+	reverse_iterator rend() { return reverse_iterator (begin()); }
 
 	//begin/end const iterators
 
-	const_iterator begin() const noexcept { return cbegin(); }
-	const_iterator end() const noexcept { return cend(); }
+	VECTOR_CONSTEXPR const_iterator begin() const { return cbegin(); }
+	VECTOR_CONSTEXPR const_iterator end() const { return cend(); }
 
-	const_iterator cbegin() const noexcept { return const_iterator (memory_begin, constIteratorContainer); }
-	const_iterator cend() const noexcept { return const_iterator (data_end, constIteratorContainer); }
+	VECTOR_CONSTEXPR const_iterator cbegin() const { containers(); return const_iterator (memory_begin, constIteratorContainer); }
+	VECTOR_CONSTEXPR const_iterator cend() const { containers(); return const_iterator (data_end, constIteratorContainer); }
 
 	//begin/end const reverse iterators
 
-	const_reverse_iterator rbegin() const noexcept { return crbegin(); }
-	const_reverse_iterator rend() const noexcept { return crend(); }
+	const_reverse_iterator rbegin() const { return crbegin(); }
+	const_reverse_iterator rend() const { return crend(); }
 
-	const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator (cend()); }
-	const_reverse_iterator crend() const noexcept { return const_reverse_iterator (cbegin()); }
+	const_reverse_iterator crbegin() const { return const_reverse_iterator (cend()); }
+	const_reverse_iterator crend() const { return const_reverse_iterator (cbegin()); }
 };
 
 template <typename T>
-Vector<T>::Vector () {
+VECTOR_CONSTEXPR Vector<T>::Vector () : sizingHint(nullptr), predictedCapacity(0), bufferGeneration(0) {
 	#ifdef DEBUG_MODE
 	std::cerr << "Vector()" << std::endl;
 	#endif
@@ -194,15 +528,55 @@ Vector<T>::Vector () {
 }
 
 template <typename T>
-Vector<T>::Vector (const Vector<T> &other) {
+VECTOR_CONSTEXPR Vector<T>::Vector (const StorageOptions &options) : storageOptions(options), sizingHint(nullptr), predictedCapacity(0), bufferGeneration(0) {
+	#ifdef DEBUG_MODE
+	std::cerr << "Vector(StorageOptions)" << std::endl;
+	#endif
+
+	memory_begin = data_end = memory_end = nullptr;
+	initContainers();
+
+	#ifdef MEMORY_TRACE_MODE
+	watcher.onVectorDefCreated ();
+	#endif
+}
+
+template <typename T>
+Vector<T>::Vector (SizingHint &hint, const StorageOptions &options) : storageOptions(options), sizingHint(&hint), predictedCapacity(hint.predict()), bufferGeneration(0) {
+	#ifdef DEBUG_MODE
+	std::cerr << "Vector(SizingHint)" << std::endl;
+	#endif
+
+	memory_begin = data_end = memory_end = nullptr;
+	initContainers();
+
+	if (predictedCapacity) {
+		VECTOR_TRY {
+			reserve(predictedCapacity);
+		}
+		VECTOR_CATCH_ALL {
+			delete iteratorContainer;
+			delete constIteratorContainer;
+
+			VECTOR_RETHROW;
+		}
+	}
+
+	#ifdef MEMORY_TRACE_MODE
+	watcher.onVectorDefCreated ();
+	#endif
+}
+
+template <typename T>
+VECTOR_CONSTEXPR Vector<T>::Vector (const Vector<T> &other) : storageOptions(other.storageOptions), sizingHint(nullptr), predictedCapacity(0), bufferGeneration(0) {
 	#ifdef DEBUG_MODE
 	std::cerr << "Vector(const &)" << std::endl;
 	#endif
 
 	initContainers();
 
-	try {
-		memory_begin = static_cast<T*>(operator new[] (other.size() * sizeof(T)));
+	VECTOR_TRY {
+		memory_begin = allocate (other.size());
 		memory_end = this->memory_begin + other.size();
 		data_end = this->memory_begin;
 
@@ -211,34 +585,33 @@ Vector<T>::Vector (const Vector<T> &other) {
 		watcher.onMemoryAllocated (std::distance (memory_begin, memory_end));
 		#endif
 
-		try {
+		VECTOR_TRY {
 			for (T *j = other.memory_begin; j < other.data_end; ++j) {
 				push_back(*j);
 			}
 		}
-		catch (...) {
-			for (T* i = memory_begin; i < data_end; ++i) {
-				i->~T();
-			}
+		VECTOR_CATCH_ALL {
+			vector_detail::destroyRange (memory_begin, data_end);
 			#ifdef MEMORY_TRACE_MODE
 			watcher.onMemoryDeallocated (std::distance(memory_begin, memory_end));
 			#endif
 
-			operator delete[] (memory_begin);
+			deallocate (memory_begin, capacity());
 
-			throw;
+			VECTOR_RETHROW;
 		}
 	}
-	catch (...) {
+	VECTOR_CATCH_ALL {
 		delete iteratorContainer;
 		delete constIteratorContainer;
 
-		throw;
+		VECTOR_RETHROW;
 	}
 }
 
 template <typename T>
-Vector<T>::Vector (Vector<T> &&other) noexcept {
+VECTOR_CONSTEXPR Vector<T>::Vector (Vector<T> &&other) noexcept
+	: storageOptions(other.storageOptions), sizingHint(other.sizingHint), predictedCapacity(other.predictedCapacity), bufferGeneration(0) {
 	#ifdef DEBUG_MODE
 	std::cerr << "Vector(&&)" << std::endl;
 	#endif
@@ -250,47 +623,80 @@ Vector<T>::Vector (Vector<T> &&other) noexcept {
 	constIteratorContainer = other.constIteratorContainer;
 
 	other.memory_begin = other.data_end = other.memory_end = nullptr;
+	other.sizingHint = nullptr; //the hint follows the moved data
+	++other.bufferGeneration;
+
+	if (iteratorContainer) {
+		iteratorContainer->vector = this;
+		constIteratorContainer->vector = this;
+	}
+
+	//moved-from vector stays usable (algorithms assign to it): its containers are made on its next begin()/end()
 	other.iteratorContainer = nullptr;
 	other.constIteratorContainer = nullptr;
 
-	iteratorContainer->vector = this;
-	constIteratorContainer->vector = this;
-
 	#ifdef MEMORY_TRACE_MODE
 	watcher.onVectorMoveCreated ();
 	#endif
 }
 
 template <typename T>
-template <typename InputIterator>
-Vector<T>::Vector (InputIterator begin, InputIterator end) {
+Vector<T>::Vector (size_t count, const T &value, size_t threads) : sizingHint(nullptr), predictedCapacity(0), bufferGeneration(0) {
 	#ifdef DEBUG_MODE
-	std::cerr << "Vector(Iterators)" << std::endl;
+	std::cerr << "Vector(size_t, const T&)" << std::endl;
 	#endif
 
 	memory_begin = data_end = memory_end = nullptr;
 	initContainers();
 
-	try {
-		IterCtorSpecializer<Vector<T>, typename std::iterator_traits<InputIterator>::iterator_category>().performReserve(this, begin, end);
+	VECTOR_TRY {
+		reserve (count);
+		appendFill (count, value, threads, std::integral_constant<bool, std::is_trivially_copyable<T>::value>());
+	}
+	VECTOR_CATCH_ALL {
+		vector_detail::destroyRange (memory_begin, data_end);
 
-		try {
-			for (InputIterator i = begin; i != end; ++i) {
-				push_back(*i);
-			}
-		}
-		catch (...) {
-			for (T* i = memory_begin; i < data_end; ++i) {
-				i->~T();
-			}
-		}
+		#ifdef MEMORY_TRACE_MODE
+		watcher.onMemoryDeallocated (std::distance (memory_begin, memory_end));
+		#endif
+
+		deallocate (memory_begin, capacity());
+		delete iteratorContainer;
+		delete constIteratorContainer;
+
+		VECTOR_RETHROW;
 	}
-	catch (...) {
-		operator delete [] (memory_begin);
+
+	#ifdef MEMORY_TRACE_MODE
+	watcher.onVectorDefCreated ();
+	#endif
+}
+
+template <typename T>
+template <typename InputIterator, typename std::enable_if<!std::is_integral<InputIterator>::value, int>::type>
+VECTOR_CONSTEXPR Vector<T>::Vector (InputIterator begin, InputIterator end) : sizingHint(nullptr), predictedCapacity(0), bufferGeneration(0) {
+	#ifdef DEBUG_MODE
+	std::cerr << "Vector(Iterators)" << std::endl;
+	#endif
+
+	memory_begin = data_end = memory_end = nullptr;
+	initContainers();
+
+	VECTOR_TRY {
+		IterCtorSpecializer<Vector<T>, typename std::iterator_traits<InputIterator>::iterator_category>().performFill(this, begin, end);
+	}
+	VECTOR_CATCH_ALL {
+		vector_detail::destroyRange (memory_begin, data_end);
+
+		#ifdef MEMORY_TRACE_MODE
+		watcher.onMemoryDeallocated (std::distance (memory_begin, memory_end));
+		#endif
+
+		deallocate (memory_begin, capacity());
 		delete iteratorContainer;
 		delete constIteratorContainer;
 
-		throw;
+		VECTOR_RETHROW;
 	}
 
 	#ifdef MEMORY_TRACE_MODE
@@ -299,7 +705,7 @@ Vector<T>::Vector (InputIterator begin, InputIterator end) {
 }
 
 template <typename T>
-Vector<T>::~Vector () noexcept {
+VECTOR_CONSTEXPR Vector<T>::~Vector () noexcept {
 	#ifdef DEBUG_MODE
 	std::cerr << "~Vector()" << std::endl;
 	#endif
@@ -315,44 +721,55 @@ Vector<T>::~Vector () noexcept {
 		constIteratorContainer->invalidateAll();
 	}
 
+	if (sizingHint) {
+		sizingHint->record (size(), predictedCapacity);
+	}
+
 	if (!memory_begin) {
 		return;
 	}
 
-	for (T* i = memory_begin; i < data_end; ++i) {
-		i->~T();
-	}
+	vector_detail::destroyRange (memory_begin, data_end);
 
 	#ifdef MEMORY_TRACE_MODE
 	watcher.onMemoryDeallocated (std::distance (memory_begin, memory_end));
 	#endif
 
-	operator delete[] (memory_begin);
+	deallocate (memory_begin, capacity());
 }
 
 template <typename T>
-Vector<T> &Vector<T>::operator= (const Vector<T> &other) {
+VECTOR_CONSTEXPR Vector<T> &Vector<T>::operator= (const Vector<T> &other) {
 	Vector<T> temp(other);
 	this->swap(temp);
 	return *this;
 }
 
 template <typename T>
-Vector<T>& Vector<T>::operator= (Vector<T> &&other) noexcept {
+VECTOR_CONSTEXPR Vector<T>& Vector<T>::operator= (Vector<T> &&other) noexcept {
 	Vector<T> temp;
 	temp.swap(other);
 	this->swap(temp);
 
+	//hints follow the data they predicted: the old contents are recorded with the old hint,
+	//the hint of 'other' moves here and its next contents start without one
+	temp.sizingHint = sizingHint;
+	temp.predictedCapacity = predictedCapacity;
+	sizingHint = other.sizingHint;
+	predictedCapacity = other.predictedCapacity;
+	other.sizingHint = nullptr;
+
 	return *this;
 }
 
 template <typename T>
-bool Vector<T>::operator== (const Vector<T> &other) const {
+VECTOR_CONSTEXPR bool Vector<T>::operator== (const Vector<T> &other) const {
 	if (size() != other.size()) {
 		return false;
 	}
 
-	for (typename Vector<T>::const_iterator thisIt = cbegin(), otherIt = other.cbegin(), thisEnd = cend(); thisIt < thisEnd; ++thisIt, ++otherIt) {
+	//raw pointers: comparing makes no iterators, so it never allocates containers
+	for (const T *thisIt = memory_begin, *otherIt = other.memory_begin; thisIt < data_end; ++thisIt, ++otherIt) {
 		if (!(*thisIt == *otherIt)) { //operator== uses only operator==
 			return false;
 		}
@@ -362,144 +779,308 @@ bool Vector<T>::operator== (const Vector<T> &other) const {
 }
 
 template <typename T>
-void Vector<T>::swap(Vector<T> &other) noexcept { //         O(1)
+VECTOR_CONSTEXPR void Vector<T>::swap(Vector<T> &other) noexcept { //         O(1)
 	this->invalidateIterators();
 	other.invalidateIterators();
 
 	std::swap(memory_begin, other.memory_begin);
 	std::swap(memory_end, other.memory_end);
 	std::swap(data_end, other.data_end);
+	std::swap(storageOptions, other.storageOptions);
 
-	//fixing links to vector inside containers
-	iteratorContainer->vector = &other;
-	constIteratorContainer->vector = &other;
-	other.iteratorContainer->vector = this;
-	other.constIteratorContainer->vector = this;
-
-	//swapping pointers
-	std::swap(iteratorContainer, other.iteratorContainer);
-	std::swap(constIteratorContainer, other.constIteratorContainer);
+	//the iterators of both vectors are invalidated: both are left without containers
 }
 
 template <typename T>
-void swap (Vector<T> &v1, Vector<T> &v2) {
+VECTOR_CONSTEXPR void swap (Vector<T> &v1, Vector<T> &v2) {
 	v1.swap(v2);
 }
 
 template <typename T>
-size_t Vector<T>::size() const noexcept {
+VECTOR_CONSTEXPR size_t Vector<T>::size() const noexcept {
 	return data_end - memory_begin;
 }
 
 template <typename T>
-inline size_t Vector<T>::max_size() const noexcept {
+VECTOR_CONSTEXPR inline size_t Vector<T>::max_size() const noexcept {
 	return std::numeric_limits<size_t>::max() / sizeof(T);
 }
 
 template <typename T>
-size_t Vector<T>::capacity() const noexcept {
+VECTOR_CONSTEXPR size_t Vector<T>::capacity() const noexcept {
 	return memory_end - memory_begin;
 }
 
 template <typename T>
-void Vector<T>::reserve(size_t new_capacity) {
+VECTOR_CONSTEXPR void Vector<T>::reserve(size_t new_capacity) {
 	if (new_capacity <= capacity()) {
 		return;
 	}
 	if (new_capacity > max_size()) {
-		throw std::runtime_error("too large capacity");
+		VECTOR_THROW(std::runtime_error("too large capacity"));
 	}
+
+	reallocate (new_capacity);
+}
+
+template <typename T>
+VECTOR_CONSTEXPR void Vector<T>::reallocate(size_t new_capacity) {
 	size_t data_size = size();
 
 	invalidateIterators();
 
-	T* begin = static_cast<T*>(operator new[](sizeof(T) * new_capacity));
+	//std::allocator storage of constant evaluation cannot be realloc'ed
+	T* begin = VECTOR_CONSTANT_EVALUATED() ? relocate (new_capacity, std::false_type())
+										   : relocate (new_capacity, std::integral_constant<bool, std::is_trivially_copyable<T>::value>());
 
 	#ifdef MEMORY_TRACE_MODE
 	watcher.onMemoryAllocated (std::distance (begin, begin + new_capacity)); //uniform memory measure - std::distance
-	#endif
-
-	for (T *i = memory_begin, *j = begin; i < data_end; ++i, ++j) {
-		new(j) T(std::move(*i));
-		i->~T();
-	}
-
 	if (memory_begin) {
-		#ifdef MEMORY_TRACE_MODE
 		watcher.onMemoryDeallocated (std::distance (memory_begin, memory_end));
-		#endif
-
-		operator delete[] (memory_begin);
 	}
+	#endif
 
 	memory_begin = begin;
 	memory_end = begin + new_capacity;
 	data_end = begin + data_size;
 }
 
+template <typename T>
+VECTOR_CONSTEXPR T* Vector<T>::relocate(size_t new_capacity, std::true_type) {
+	return static_cast<T*>(reallocateStorage (memory_begin, capacity() * sizeof(T), new_capacity * sizeof(T), storageOptions));
+}
+
+template <typename T>
+VECTOR_CONSTEXPR T* Vector<T>::relocate(size_t new_capacity, std::false_type) {
+	T* begin = allocate (new_capacity);
+
+	for (T *i = memory_begin, *j = begin; i < data_end; ++i, ++j) {
+		vector_detail::constructAt (j, std::move(*i));
+	}
+	vector_detail::destroyRange (memory_begin, data_end);
+
+	deallocate (memory_begin, capacity());
+
+	return begin;
+}
+
 template <typename T>
 void Vector<T>::shrink_to_fit() {
-	if (size() < capacity()) {
-		Vector<T> temp(*this);
+	shrink_to(size());
+}
+
+template <typename T>
+void Vector<T>::shrink_to(size_t new_capacity) {
+	if (new_capacity < size()) {
+		new_capacity = size();
+	}
+	if (new_capacity >= capacity()) {
+		return;
+	}
+
+	if (new_capacity == 0) { //empty vector: just releasing the buffer
+		Vector<T> temp(storageOptions);
 		this->swap(temp);
+		return;
 	}
+
+	reallocate (new_capacity);
 }
 
 template <typename T>
-void Vector<T>::clear() noexcept {
-	Vector<T> temp;
+VECTOR_CONSTEXPR void Vector<T>::clear() noexcept {
+	Vector<T> temp(storageOptions);
+	this->swap(temp);
+}
+
+template <typename T>
+VECTOR_CONSTEXPR void Vector<T>::clear(bool keep_capacity) noexcept {
+	if (keep_capacity) {
+		truncate(0);
+	}
+	else {
+		clear();
+	}
+}
+
+template <typename T>
+void Vector<T>::set_storage_options(const StorageOptions &options) {
+	if (!memory_begin) {
+		storageOptions = options;
+		return;
+	}
+
+	Vector<T> temp(options);
+	temp.reserve(capacity());
+	for (T* i = memory_begin; i < data_end; ++i) {
+		temp.push_back(std::move(*i));
+	}
 	this->swap(temp);
 }
 
 template <typename T>
-inline T &Vector<T>::operator[](size_t index) {
+VECTOR_CONSTEXPR inline T &Vector<T>::operator[](size_t index) {
 	if (index >= size()) {
-		throw IndexOutOfRangeException ("Index out of range");
+		VECTOR_THROW(IndexOutOfRangeException ("Index out of range"));
 	}
 
 	return *(memory_begin + index);
 }
 
 template <typename T>
-inline const T &Vector<T>::operator[](size_t index) const {
+VECTOR_CONSTEXPR inline const T &Vector<T>::operator[](size_t index) const {
 	if (index >= size()) {
-		throw IndexOutOfRangeException ("Index out of range");
+		VECTOR_THROW(IndexOutOfRangeException ("Index out of range"));
 	}
 
 	return static_cast<const T&>(*(memory_begin + index));
 }
 
 template <typename T>
-void Vector<T>::push_back(const T &value) {
+VECTOR_CONSTEXPR void Vector<T>::push_back(const T &value) {
 	reserve(getOptimalNewCapacity(size() + 1));
 
 	if (size() == capacity()) {
-		throw std::runtime_error ("No memory to place an element");
+		VECTOR_THROW(std::runtime_error ("No memory to place an element"));
 	}
 
-	new(data_end)T(value);
+	vector_detail::constructAt (data_end, value);
 	++data_end;
 }
 
 template <typename T>
-void Vector<T>::push_back(T &&value) {
+VECTOR_CONSTEXPR void Vector<T>::push_back(T &&value) {
 	reserve(getOptimalNewCapacity(size() + 1));
 
 	if (size() == capacity()) {
-		throw std::runtime_error ("No memory to place an element");
+		VECTOR_THROW(std::runtime_error ("No memory to place an element"));
 	}
 
-	new(data_end)T(std::move(value));
+	vector_detail::constructAt (data_end, std::move(value));
 	++data_end;
 }
 
 template<typename T>
-void Vector<T>::pop_back() {
+VECTOR_CONSTEXPR void Vector<T>::pop_back() {
 	if (data_end > memory_begin) {
-		(data_end - 1)->~T();
+		vector_detail::destroyRange (data_end - 1, data_end);
 		--data_end;
+		++bufferGeneration;
 	}
 	else {
-		throw InvalidOperationException ("Cannot pop from empty vector");
+		VECTOR_THROW(InvalidOperationException ("Cannot pop from empty vector"));
 	}
 }
+
+template <typename T>
+VectorExpected<void> Vector<T>::try_reserve(size_t new_capacity) {
+	if (new_capacity <= capacity()) {
+		return VectorExpected<void>();
+	}
+	if (new_capacity > max_size()) {
+		return VectorError::capacity_too_large;
+	}
+
+	#ifdef VECTOR_NO_EXCEPTIONS
+	reallocate (new_capacity);
+	#else
+	try {
+		reallocate (new_capacity);
+	}
+	catch (const std::bad_alloc &) {
+		return VectorError::out_of_memory;
+	}
+	#endif
+
+	return VectorExpected<void>();
+}
+
+template <typename T>
+VectorExpected<void> Vector<T>::try_push_back(const T &value) {
+	if (size() == capacity()) {
+		if (size() == max_size()) {
+			return VectorError::capacity_too_large;
+		}
+
+		VectorExpected<void> grown = try_reserve(getOptimalNewCapacity(size() + 1));
+		if (!grown) {
+			return grown;
+		}
+	}
+
+	vector_detail::constructAt (data_end, value);
+	++data_end;
+	return VectorExpected<void>();
+}
+
+template <typename T>
+VectorExpected<void> Vector<T>::try_push_back(T &&value) {
+	if (size() == capacity()) {
+		if (size() == max_size()) {
+			return VectorError::capacity_too_large;
+		}
+
+		VectorExpected<void> grown = try_reserve(getOptimalNewCapacity(size() + 1));
+		if (!grown) {
+			return grown;
+		}
+	}
+
+	vector_detail::constructAt (data_end, std::move(value));
+	++data_end;
+	return VectorExpected<void>();
+}
+
+template <typename T>
+VectorExpected<T> Vector<T>::at_checked(size_t index) noexcept {
+	if (index >= size()) {
+		return VectorError::index_out_of_range;
+	}
+	return memory_begin[index];
+}
+
+template <typename T>
+VectorExpected<const T> Vector<T>::at_checked(size_t index) const noexcept {
+	if (index >= size()) {
+		return VectorError::index_out_of_range;
+	}
+	return memory_begin[index];
+}
+
+template <typename T>
+void Vector<T>::assign(size_t count, const T &value, size_t threads) {
+	if (&value >= memory_begin && &value < data_end) { //the value is about to be destroyed
+		T copy(value);
+		assign (count, copy, threads);
+		return;
+	}
+
+	truncate (0);
+	reserve (count);
+	appendFill (count, value, threads, std::integral_constant<bool, std::is_trivially_copyable<T>::value>());
+}
+
+template<typename T>
+VECTOR_CONSTEXPR void Vector<T>::truncate(size_t new_size) noexcept {
+	if (new_size >= size()) {
+		return;
+	}
+
+	vector_detail::destroyRange (memory_begin + new_size, data_end);
+	data_end = memory_begin + new_size;
+	++bufferGeneration;
+}
+
+template<typename T>
+VECTOR_CONSTEXPR void Vector<T>::pop_back_n(size_t count) {
+	if (count > size()) {
+		VECTOR_THROW(InvalidOperationException ("Cannot pop more elements than vector has"));
+	}
+
+	truncate (size() - count);
+}
+
+#include "VectorView.h"
+#include "VectorChunks.h"
+#include "CheckedRange.h"
+#include "VectorBool.h"
@@ -0,0 +1,486 @@
+//Performance measurements for Vector. Not a test: build it with optimizations, e.g.
+//g++ -std=c++11 -O2 VectorBenchmark.cpp -o VectorBenchmark
+//Usage: VectorBenchmark [max buffer size in MB] [elements to sort]
+
+#include "Vector.h"
+#include "VectorSort.h"
+#include "VectorLoader.h"
+#include "VectorHash.h"
+#include "PersistentVector.h"
+#include "RcuVector.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+#pragma region utility
+
+class Stopwatch {
+private:
+	chrono::steady_clock::time_point start;
+public:
+	Stopwatch () : start(chrono::steady_clock::now()) { }
+
+	double elapsedMs () const {
+		return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+	}
+};
+
+//keeps the optimizer from dropping the measured work
+volatile size_t sink;
+
+#pragma endregion
+
+#pragma region growth
+
+//Grows a Vector<int> by doubling from one page up to 'maxBytes', filling every new buffer completely.
+//Only the reserve() calls (the relocations) are timed.
+void benchmarkGrowth (const char* name, const StorageOptions &options, size_t maxBytes) {
+	Vector<int> v(options);
+	size_t capacity = SMALL_PAGE_SIZE / sizeof(int);
+	double total = 0;
+
+	cout << name << endl;
+
+	while (capacity * sizeof(int) <= maxBytes) {
+		Stopwatch watch;
+		v.reserve(capacity);
+		double elapsed = watch.elapsedMs();
+		total += elapsed;
+
+		if (capacity * sizeof(int) >= 16 * 1024 * 1024) {
+			cout << "  grow to " << setw(6) << capacity * sizeof(int) / (1024 * 1024) << " MB: " << fixed << setprecision(3) << elapsed << " ms" << endl;
+		}
+
+		for (size_t i = v.size(); i < capacity; ++i) {
+			v.push_back(static_cast<int>(i));
+		}
+		capacity *= 2;
+	}
+
+	sink = v.size();
+	cout << "  total relocation time: " << fixed << setprecision(3) << total << " ms" << endl;
+}
+
+void benchmarkGrowth (size_t maxBytes) {
+	cout << endl << ">>>" << "benchmarkGrowth()" << endl;
+
+	StorageOptions copying = StorageOptions::cacheAligned();
+	copying.mmapThreshold = 0;
+	benchmarkGrowth("copying growth (aligned buffer, memcpy on every reserve)", copying, maxBytes);
+
+	StorageOptions mapped;
+	mapped.mmapThreshold = HUGE_PAGE_SIZE;
+	benchmarkGrowth("mremap growth (anonymous mapping above 2 MB)", mapped, maxBytes);
+}
+
+#pragma endregion
+
+#pragma region sort
+
+template <typename T>
+T randomValue ();
+
+template <>
+int randomValue<int> () {
+	return static_cast<int>((static_cast<unsigned>(rand()) << 16) ^ static_cast<unsigned>(rand()));
+}
+
+template <>
+double randomValue<double> () {
+	return (rand() - RAND_MAX / 2) * 1e-3 + rand() * 1e-9;
+}
+
+template <>
+string randomValue<string> () {
+	return to_string(randomValue<int>());
+}
+
+//std::sort of a std::vector against 'sortVector' of a Vector holding the same values
+template <typename T, typename Sort>
+void benchmarkSort (const char* name, size_t count, const Sort &sortVector) {
+	vector<T> sysVector;
+	for (size_t i = 0; i < count; ++i) {
+		sysVector.push_back(randomValue<T>());
+	}
+	Vector<T> myVector(sysVector.begin(), sysVector.end());
+
+	Stopwatch sysWatch;
+	std::sort(sysVector.begin(), sysVector.end());
+	double sysElapsed = sysWatch.elapsedMs();
+
+	Stopwatch myWatch;
+	sortVector(myVector);
+	double myElapsed = myWatch.elapsedMs();
+
+	bool same = true;
+	for (size_t i = 0; i < count && same; ++i) {
+		same = myVector[i] == sysVector[i];
+	}
+
+	sink = myVector.size();
+	cout << "  " << setw(32) << left << name << right << ": std::sort " << fixed << setprecision(1) << setw(8) << sysElapsed
+		<< " ms, Vector " << setw(8) << myElapsed << " ms, x" << setprecision(2) << sysElapsed / myElapsed
+		<< (same ? "" : "  (RESULTS DIFFER)") << endl;
+}
+
+void benchmarkSort (size_t count) {
+	cout << endl << ">>>" << "benchmarkSort(" << count << ")" << endl;
+
+	benchmarkSort<int>("radix_sort<int>", count, [](Vector<int> &v) { radix_sort(v); });
+	benchmarkSort<double>("radix_sort<double>", count, [](Vector<double> &v) { radix_sort(v); });
+	benchmarkSort<int>("parallel_sort<int>", count, [](Vector<int> &v) { parallel_sort(v); });
+	benchmarkSort<string>("parallel_sort<string>", count / 4, [](Vector<string> &v) { parallel_sort(v); });
+}
+
+#pragma endregion
+
+#pragma region load
+
+//fread + push_back loop against VectorLoader on a file of 'megabytes' MB of ints (served from the page cache)
+void benchmarkLoad (size_t megabytes) {
+	cout << endl << ">>>" << "benchmarkLoad(" << megabytes << " MB)" << endl;
+
+	const char* path = "VectorBenchmark.tmp";
+	size_t count = megabytes * 1024 * 1024 / sizeof(int);
+	{
+		vector<int> values(count);
+		for (size_t i = 0; i < count; ++i) {
+			values[i] = static_cast<int>(i);
+		}
+		FILE *file = fopen(path, "wb");
+		fwrite(values.data(), sizeof(int), count, file);
+		fclose(file);
+	}
+
+	Stopwatch pushWatch;
+	{
+		Vector<int> v;
+		FILE *file = fopen(path, "rb");
+		int buffer[4096];
+		size_t got;
+		while ((got = fread(buffer, sizeof(int), 4096, file)) > 0) {
+			for (size_t i = 0; i < got; ++i) {
+				v.push_back(buffer[i]);
+			}
+		}
+		fclose(file);
+		sink = v.size();
+	}
+	double pushElapsed = pushWatch.elapsedMs();
+
+	Stopwatch loadWatch;
+	{
+		Vector<int> v;
+		VectorLoader<int>().load(path, v);
+		sink = v.size();
+	}
+	double loadElapsed = loadWatch.elapsedMs();
+
+	Stopwatch transformWatch;
+	{
+		Vector<int> v;
+		VectorLoader<int>().load(path, v, [](int *records, size_t n) {
+			for (size_t i = 0; i < n; ++i) {
+				records[i] += 1;
+			}
+		});
+		sink = v.size();
+	}
+	double transformElapsed = transformWatch.elapsedMs();
+
+	remove(path);
+
+	cout << fixed << setprecision(1);
+	cout << "  fread + push_back:        " << setw(8) << pushElapsed << " ms" << endl;
+	cout << "  VectorLoader:             " << setw(8) << loadElapsed << " ms, " << megabytes * 1000.0 / loadElapsed << " MB/s" << endl;
+	cout << "  VectorLoader + transform: " << setw(8) << transformElapsed << " ms" << endl;
+}
+
+#pragma endregion
+
+#pragma region fill
+
+//'count' copies of a value: push_back loop, fill constructor, parallel first-touch fill
+void benchmarkFill (size_t count) {
+	cout << endl << ">>>" << "benchmarkFill(" << count << ")" << endl;
+
+	Stopwatch pushWatch;
+	{
+		Vector<int> v;
+		for (size_t i = 0; i < count; ++i) {
+			v.push_back(7);
+		}
+		sink = v.size();
+	}
+	double pushElapsed = pushWatch.elapsedMs();
+
+	Stopwatch fillWatch;
+	{
+		Vector<int> v(count, 7);
+		sink = v.size();
+	}
+	double fillElapsed = fillWatch.elapsedMs();
+
+	size_t threads = thread::hardware_concurrency() ? thread::hardware_concurrency() : 1;
+	Stopwatch parallelWatch;
+	{
+		Vector<int> v(count, 7, threads);
+		sink = v.size();
+	}
+	double parallelElapsed = parallelWatch.elapsedMs();
+
+	cout << fixed << setprecision(1);
+	cout << "  push_back:              " << setw(8) << pushElapsed << " ms" << endl;
+	cout << "  Vector(n, value):       " << setw(8) << fillElapsed << " ms" << endl;
+	cout << "  Vector(n, value, " << setw(2) << threads << "):   " << setw(8) << parallelElapsed << " ms" << endl;
+}
+
+#pragma endregion
+
+#pragma region traversal
+
+//Sums 'count' ints 'rounds' times: checked range-for, checked(), raw pointer loop and for_each_chunk
+void benchmarkTraversal (size_t count, size_t rounds) {
+	cout << endl << ">>>" << "benchmarkTraversal(" << count << ")" << endl;
+
+	Vector<int> v;
+	v.reserve(count);
+	for (size_t i = 0; i < count; ++i) {
+		v.push_back(static_cast<int>(i & 0xff));
+	}
+
+	Stopwatch checkedWatch;
+	for (size_t round = 0; round < rounds; ++round) {
+		long long sum = 0;
+		for (int value : v) {
+			sum += value;
+		}
+		sink = static_cast<size_t>(sum);
+	}
+	double checkedElapsed = checkedWatch.elapsedMs();
+
+	Stopwatch rangeWatch;
+	for (size_t round = 0; round < rounds; ++round) {
+		long long sum = 0;
+		for (int value : v.checked()) {
+			sum += value;
+		}
+		sink = static_cast<size_t>(sum);
+	}
+	double rangeElapsed = rangeWatch.elapsedMs();
+
+	Stopwatch rawWatch;
+	for (size_t round = 0; round < rounds; ++round) {
+		long long sum = 0;
+		for (const int *i = v.data(), *end = v.data() + v.size(); i < end; ++i) {
+			sum += *i;
+		}
+		sink = static_cast<size_t>(sum);
+	}
+	double rawElapsed = rawWatch.elapsedMs();
+
+	Stopwatch chunkWatch;
+	for (size_t round = 0; round < rounds; ++round) {
+		long long sum = 0;
+		v.for_each_chunk([&sum](const int *data, size_t n) {
+			for (size_t i = 0; i < n; ++i) {
+				sum += data[i];
+			}
+		});
+		sink = static_cast<size_t>(sum);
+	}
+	double chunkElapsed = chunkWatch.elapsedMs();
+
+	cout << fixed << setprecision(1);
+	cout << "  checked iterators: " << setw(8) << checkedElapsed << " ms" << endl;
+	cout << "  checked():         " << setw(8) << rangeElapsed << " ms" << endl;
+	cout << "  raw pointers:      " << setw(8) << rawElapsed << " ms" << endl;
+	cout << "  for_each_chunk:    " << setw(8) << chunkElapsed << " ms" << endl;
+}
+
+#pragma endregion
+
+#pragma region hash
+
+//std::hash<Vector<int>> (raw byte block hash) against combining std::hash<int> of every element
+void benchmarkHash (size_t count, size_t rounds) {
+	cout << endl << ">>>" << "benchmarkHash(" << count << ")" << endl;
+
+	Vector<int> v;
+	v.reserve(count);
+	for (size_t i = 0; i < count; ++i) {
+		v.push_back(static_cast<int>(i * 2654435761u));
+	}
+
+	Stopwatch blockWatch;
+	for (size_t round = 0; round < rounds; ++round) {
+		sink = hash<Vector<int>>()(v);
+	}
+	double blockElapsed = blockWatch.elapsedMs();
+
+	Stopwatch elementWatch;
+	for (size_t round = 0; round < rounds; ++round) {
+		sink = hash_detail::hashElements(v.data(), v.size(), false_type());
+	}
+	double elementElapsed = elementWatch.elapsedMs();
+
+	double megabytes = static_cast<double>(count * sizeof(int) * rounds) / (1024 * 1024);
+	cout << fixed << setprecision(1);
+	cout << "  block hash:    " << setw(8) << blockElapsed << " ms, " << megabytes * 1000 / blockElapsed << " MB/s" << endl;
+	cout << "  element hash:  " << setw(8) << elementElapsed << " ms, " << megabytes * 1000 / elementElapsed << " MB/s" << endl;
+}
+
+#pragma endregion
+
+#pragma region snapshots
+
+//'snapshots' point-in-time copies of 'count' ints, one element changed between them:
+//deep Vector copies against PersistentVector versions sharing their unchanged nodes
+void benchmarkSnapshots (size_t count, size_t snapshots) {
+	cout << endl << ">>>" << "benchmarkSnapshots(" << count << ")" << endl;
+
+	Vector<int> v;
+	v.reserve(count);
+	for (size_t i = 0; i < count; ++i) {
+		v.push_back(static_cast<int>(i));
+	}
+	PersistentVector<int> p (v);
+
+	Stopwatch copyWatch;
+	{
+		Vector<Vector<int>> copies;
+		for (size_t s = 0; s < snapshots; ++s) {
+			v[s % count] = static_cast<int>(s);
+			copies.push_back(v);
+		}
+		sink = copies.size();
+	}
+	double copyElapsed = copyWatch.elapsedMs();
+
+	Stopwatch persistentWatch;
+	{
+		Vector<PersistentVector<int>> versions;
+		for (size_t s = 0; s < snapshots; ++s) {
+			p = p.set(s % count, static_cast<int>(s));
+			versions.push_back(p);
+		}
+		sink = versions.size();
+	}
+	double persistentElapsed = persistentWatch.elapsedMs();
+
+	cout << fixed << setprecision(1);
+	cout << "  Vector copies:        " << setw(8) << copyElapsed << " ms" << endl;
+	cout << "  PersistentVector:     " << setw(8) << persistentElapsed << " ms" << endl;
+}
+
+#pragma endregion
+
+#pragma region published reads
+
+//'readsPerThread' scans of a small table on 1..maxThreads threads: RcuVector guards against a mutex
+void benchmarkPublishedReads (size_t readsPerThread, size_t maxThreads) {
+	cout << endl << ">>>" << "benchmarkPublishedReads(" << readsPerThread << ")" << endl;
+
+	Vector<int> table;
+	for (int i = 0; i < 64; ++i) {
+		table.push_back(i);
+	}
+	RcuVector<int> published (table);
+	mutex tableMutex;
+
+	cout << fixed << setprecision(1);
+	for (size_t threadCount = 1; threadCount <= maxThreads; threadCount *= 2) {
+		vector<thread> threads;
+		Stopwatch rcuWatch;
+		for (size_t t = 0; t < threadCount; ++t) {
+			threads.push_back(thread([&]() {
+				size_t sum = 0;
+				for (size_t r = 0; r < readsPerThread; ++r) {
+					RcuReadGuard<int> guard = published.read();
+					sum += static_cast<size_t>((*guard)[r & 63]);
+				}
+				sink = sum;
+			}));
+		}
+		for (size_t t = 0; t < threads.size(); ++t) {
+			threads[t].join();
+		}
+		double rcuElapsed = rcuWatch.elapsedMs();
+
+		threads.clear();
+		Stopwatch mutexWatch;
+		for (size_t t = 0; t < threadCount; ++t) {
+			threads.push_back(thread([&]() {
+				size_t sum = 0;
+				for (size_t r = 0; r < readsPerThread; ++r) {
+					lock_guard<mutex> lock(tableMutex);
+					sum += static_cast<size_t>(table[r & 63]);
+				}
+				sink = sum;
+			}));
+		}
+		for (size_t t = 0; t < threads.size(); ++t) {
+			threads[t].join();
+		}
+		double mutexElapsed = mutexWatch.elapsedMs();
+
+		cout << "  " << threadCount << " threads: RcuVector " << setw(8) << rcuElapsed << " ms, mutex " << setw(8) << mutexElapsed << " ms" << endl;
+	}
+}
+
+#pragma endregion
+
+#pragma region destroy
+
+//Destruction and bulk shrink of 'count' ints: no destructor loop runs, only the buffer is freed
+void benchmarkDestroy (size_t count) {
+	cout << endl << ">>>" << "benchmarkDestroy(" << count << ")" << endl;
+
+	Vector<int> *v = new Vector<int>();
+	v->reserve(count);
+	for (size_t i = 0; i < count; ++i) {
+		v->push_back(static_cast<int>(i));
+	}
+
+	Stopwatch truncateWatch;
+	v->truncate(count / 2);
+	v->pop_back_n(count / 4);
+	double truncateElapsed = truncateWatch.elapsedMs();
+	sink = v->size();
+
+	Stopwatch destroyWatch;
+	delete v;
+	double destroyElapsed = destroyWatch.elapsedMs();
+
+	cout << fixed << setprecision(3);
+	cout << "  truncate + pop_back_n: " << setw(10) << truncateElapsed << " ms" << endl;
+	cout << "  ~Vector:               " << setw(10) << destroyElapsed << " ms" << endl;
+}
+
+#pragma endregion
+
+int main (int argc, char **argv) {
+	size_t maxMegabytes = argc > 1 ? static_cast<size_t>(atol(argv[1])) : 512;
+	size_t sortCount = argc > 2 ? static_cast<size_t>(atol(argv[2])) : 10 * 1000 * 1000;
+
+	benchmarkGrowth(maxMegabytes * 1024 * 1024);
+	benchmarkSort(sortCount);
+	benchmarkLoad(256);
+	benchmarkFill(sortCount * 10);
+	benchmarkTraversal(sortCount, 10);
+	benchmarkHash(sortCount, 10);
+	benchmarkSnapshots(sortCount, 100);
+	benchmarkPublishedReads(sortCount, 4);
+	benchmarkDestroy(sortCount * 10);
+
+	return 0;
+}
@@ -0,0 +1,368 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include "Vector.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(_MSC_FULL_VER) && _MSC_FULL_VER < 180000000
+#define noexcept throw()
+#endif
+
+namespace bit_detail {
+	const size_t WORD_BITS = 64;
+
+	inline size_t popcount (uint64_t word) noexcept {
+		#if defined(__GNUC__) || defined(__clang__)
+		return static_cast<size_t>(__builtin_popcountll(word));
+		#elif defined(_MSC_VER) && defined(_M_X64)
+		return static_cast<size_t>(__popcnt64(word));
+		#else
+		size_t count = 0;
+		for (; word; word &= word - 1) {
+			++count;
+		}
+		return count;
+		#endif
+	}
+
+	//index of the lowest set bit, word must not be 0
+	inline size_t lowestBit (uint64_t word) noexcept {
+		#if defined(__GNUC__) || defined(__clang__)
+		return static_cast<size_t>(__builtin_ctzll(word));
+		#elif defined(_MSC_VER) && defined(_M_X64)
+		unsigned long index;
+		_BitScanForward64(&index, word);
+		return index;
+		#else
+		size_t index = 0;
+		while (!(word & 1)) {
+			word >>= 1;
+			++index;
+		}
+		return index;
+		#endif
+	}
+
+	inline size_t wordsFor (size_t bits) noexcept {
+		return (bits + WORD_BITS - 1) / WORD_BITS;
+	}
+}
+
+///<summary>
+///Reference to a single bit of Vector&lt;bool&gt;
+///</summary>
+class BitReference {
+private:
+	uint64_t *word;
+	uint64_t mask;
+
+public:
+	BitReference (uint64_t *word, uint64_t mask) noexcept : word(word), mask(mask) { }
+
+	operator bool () const noexcept { return (*word & mask) != 0; }
+
+	BitReference& operator= (bool value) noexcept {
+		if (value) {
+			*word |= mask;
+		}
+		else {
+			*word &= ~mask;
+		}
+		return *this;
+	}
+
+	BitReference& operator= (const BitReference &other) noexcept {
+		return *this = static_cast<bool>(other);
+	}
+
+	void flip () noexcept { *word ^= mask; }
+};
+
+///<summary>
+///Random access iterator of Vector&lt;bool&gt;: vector pointer and bit index.
+///</summary>
+template <typename BitVector>
+class BitIterator {
+private:
+	BitVector *vector;
+	size_t index;
+
+	void checkDomainEquality (const BitIterator<BitVector> &another) const {
+		if (vector != another.vector) {
+			VECTOR_THROW(DifferentIteratorDomainException());
+		}
+	}
+
+public:
+	typedef std::random_access_iterator_tag iterator_category;
+	typedef bool value_type;
+	typedef ptrdiff_t difference_type;
+	typedef void pointer;
+	typedef typename std::conditional<std::is_const<BitVector>::value, bool, BitReference>::type reference;
+
+	BitIterator () noexcept : vector(nullptr), index(0) { }
+	BitIterator (BitVector *vector, size_t index) noexcept : vector(vector), index(index) { }
+
+	//iterator -> const_iterator
+	operator BitIterator<const BitVector> () const noexcept { return BitIterator<const BitVector> (vector, index); }
+
+	reference operator* () const {
+		if (!vector) {
+			VECTOR_THROW(InvalidIteratorException());
+		}
+		if (index >= vector->size()) {
+			VECTOR_THROW(IteratorOutOfRangeException());
+		}
+		return (*vector)[index];
+	}
+
+	reference operator[] (ptrdiff_t offset) const { return *(*this + offset); }
+
+	BitIterator& operator+= (ptrdiff_t offset) {
+		if (!vector) {
+			VECTOR_THROW(InvalidIteratorException());
+		}
+		if (offset >= 0 ? vector->size() - index < static_cast<size_t>(offset) : index < static_cast<size_t>(-offset)) {
+			VECTOR_THROW(InvalidIteratorShiftException());
+		}
+		index += offset;
+		return *this;
+	}
+
+	BitIterator& operator-= (ptrdiff_t offset) { return *this += -offset; }
+	BitIterator& operator++ () { return *this += 1; }
+	BitIterator& operator-- () { return *this -= 1; }
+	BitIterator operator++ (int) { BitIterator clone(*this); ++*this; return clone; }
+	BitIterator operator-- (int) { BitIterator clone(*this); --*this; return clone; }
+	BitIterator operator+ (ptrdiff_t offset) const { BitIterator result(*this); return result += offset; }
+	BitIterator operator- (ptrdiff_t offset) const { BitIterator result(*this); return result -= offset; }
+
+	ptrdiff_t operator- (const BitIterator &another) const {
+		checkDomainEquality(another);
+		return static_cast<ptrdiff_t>(index) - static_cast<ptrdiff_t>(another.index);
+	}
+
+	bool operator== (const BitIterator &another) const { checkDomainEquality(another); return index == another.index; }
+	bool operator!= (const BitIterator &another) const { return !(*this == another); }
+	bool operator< (const BitIterator &another) const { checkDomainEquality(another); return index < another.index; }
+	bool operator> (const BitIterator &another) const { return another < *this; }
+	bool operator<= (const BitIterator &another) const { return !(another < *this); }
+	bool operator>= (const BitIterator &another) const { return !(*this < another); }
+
+	friend BitIterator operator+ (ptrdiff_t offset, const BitIterator &iter) { return iter + offset; }
+};
+
+///<summary>
+///Packed Vector of bits: 64 flags per uint64_t word, stored in a Vector&lt;uint64_t&gt;.
+///Bits past size() in the last word are always zero, so bulk operations work word by word.
+///Iterators are index based: they stay valid across reallocation and check bounds on access.
+///</summary>
+template <>
+class Vector<bool> {
+private:
+	Vector<uint64_t> words;
+	size_t bits;
+
+	void checkSameSize (const Vector<bool> &other) const {
+		if (bits != other.bits) {
+			VECTOR_THROW(InvalidOperationException ("Bit vectors have different sizes"));
+		}
+	}
+
+	//zeroes the bits past size() in the last word
+	void trimLastWord () noexcept {
+		if (bits % bit_detail::WORD_BITS) {
+			words.data()[words.size() - 1] &= (uint64_t(1) << (bits % bit_detail::WORD_BITS)) - 1;
+		}
+	}
+
+public:
+	typedef bool value_type;
+	typedef BitReference reference;
+	typedef bool const_reference;
+	typedef BitIterator<Vector<bool>> iterator;
+	typedef BitIterator<const Vector<bool>> const_iterator;
+
+	typedef InvalidOperationException invalid_operation_exception;
+	typedef IndexOutOfRangeException index_out_of_range_exception;
+
+	Vector () : bits(0) { }
+	explicit Vector (const StorageOptions &options) : words(options), bits(0) { }
+
+	Vector (size_t count, bool value) : words(bit_detail::wordsFor(count), value ? ~uint64_t(0) : 0), bits(count) {
+		trimLastWord();
+	}
+
+	template <typename InputIterator, typename std::enable_if<!std::is_integral<InputIterator>::value, int>::type = 0>
+	Vector (InputIterator begin, InputIterator end) : bits(0) {
+		for (InputIterator i = begin; i != end; ++i) {
+			push_back(static_cast<bool>(*i));
+		}
+	}
+
+	Vector (const Vector<bool> &other) : words(other.words), bits(other.bits) { }
+	Vector (Vector<bool> &&other) noexcept : words(std::move(other.words)), bits(other.bits) { other.bits = 0; }
+
+	Vector<bool>& operator= (const Vector<bool> &other) {
+		Vector<bool> temp(other);
+		swap(temp);
+		return *this;
+	}
+
+	Vector<bool>& operator= (Vector<bool> &&other) noexcept {
+		Vector<bool> temp(std::move(other));
+		swap(temp);
+		return *this;
+	}
+
+	bool operator== (const Vector<bool> &other) const { return bits == other.bits && words == other.words; }
+	bool operator!= (const Vector<bool> &other) const { return !(*this == other); }
+
+	void swap (Vector<bool> &other) noexcept {
+		words.swap(other.words);
+		std::swap(bits, other.bits);
+	}
+
+	bool empty () const noexcept { return bits == 0; }
+	size_t size () const noexcept { return bits; }
+	size_t max_size () const noexcept { return words.max_size() / 2 * bit_detail::WORD_BITS; }
+	size_t capacity () const noexcept { return words.capacity() * bit_detail::WORD_BITS; }
+
+	void reserve (size_t new_capacity) { words.reserve(bit_detail::wordsFor(new_capacity)); }
+	void shrink_to_fit () { words.shrink_to_fit(); }
+
+	void clear () noexcept {
+		words.clear();
+		bits = 0;
+	}
+
+	reference operator[] (size_t index) {
+		if (index >= bits) {
+			VECTOR_THROW(IndexOutOfRangeException ("Index out of range"));
+		}
+		return reference (words.data() + index / bit_detail::WORD_BITS, uint64_t(1) << (index % bit_detail::WORD_BITS));
+	}
+
+	bool operator[] (size_t index) const {
+		if (index >= bits) {
+			VECTOR_THROW(IndexOutOfRangeException ("Index out of range"));
+		}
+		return (words.data()[index / bit_detail::WORD_BITS] >> (index % bit_detail::WORD_BITS)) & 1;
+	}
+
+	void push_back (bool value) {
+		if (bits % bit_detail::WORD_BITS == 0) {
+			words.push_back(0);
+		}
+		if (value) {
+			words.data()[bits / bit_detail::WORD_BITS] |= uint64_t(1) << (bits % bit_detail::WORD_BITS);
+		}
+		++bits;
+	}
+
+	void pop_back () {
+		if (!bits) {
+			VECTOR_THROW(InvalidOperationException ("Cannot pop from empty vector"));
+		}
+		--bits;
+		if (bits % bit_detail::WORD_BITS == 0) {
+			words.pop_back();
+		}
+		else {
+			trimLastWord();
+		}
+	}
+
+	//raw packed words: bit i is (word_data()[i / 64] >> (i % 64)) & 1
+	const uint64_t* word_data () const noexcept { return words.data(); }
+	size_t word_count () const noexcept { return words.size(); }
+
+	//number of set bits
+	size_t count () const noexcept {
+		const uint64_t *word = words.data();
+		size_t result = 0;
+		for (size_t i = 0, sz = words.size(); i < sz; ++i) {
+			result += bit_detail::popcount(word[i]);
+		}
+		return result;
+	}
+
+	//index of the first set bit at or after 'from', size() if there is none
+	size_t find_next (size_t from) const noexcept {
+		if (from >= bits) {
+			return bits;
+		}
+
+		const uint64_t *word = words.data();
+		size_t i = from / bit_detail::WORD_BITS;
+		uint64_t current = word[i] & (~uint64_t(0) << (from % bit_detail::WORD_BITS));
+
+		for (size_t sz = words.size(); ; ) {
+			if (current) {
+				return i * bit_detail::WORD_BITS + bit_detail::lowestBit(current);
+			}
+			if (++i == sz) {
+				return bits;
+			}
+			current = word[i];
+		}
+	}
+
+	size_t find_first () const noexcept { return find_next(0); }
+
+	bool any () const noexcept { return find_first() != bits; }
+	bool none () const noexcept { return !any(); }
+	bool all () const noexcept { return count() == bits; }
+
+	Vector<bool>& operator&= (const Vector<bool> &other) {
+		checkSameSize(other);
+		uint64_t *word = words.data();
+		const uint64_t *otherWord = other.words.data();
+		for (size_t i = 0, sz = words.size(); i < sz; ++i) {
+			word[i] &= otherWord[i];
+		}
+		return *this;
+	}
+
+	Vector<bool>& operator|= (const Vector<bool> &other) {
+		checkSameSize(other);
+		uint64_t *word = words.data();
+		const uint64_t *otherWord = other.words.data();
+		for (size_t i = 0, sz = words.size(); i < sz; ++i) {
+			word[i] |= otherWord[i];
+		}
+		return *this;
+	}
+
+	Vector<bool>& operator^= (const Vector<bool> &other) {
+		checkSameSize(other);
+		uint64_t *word = words.data();
+		const uint64_t *otherWord = other.words.data();
+		for (size_t i = 0, sz = words.size(); i < sz; ++i) {
+			word[i] ^= otherWord[i];
+		}
+		return *this;
+	}
+
+	//inverts every bit
+	void flip () noexcept {
+		uint64_t *word = words.data();
+		for (size_t i = 0, sz = words.size(); i < sz; ++i) {
+			word[i] = ~word[i];
+		}
+		trimLastWord();
+	}
+
+	iterator begin () noexcept { return iterator (this, 0); }
+	iterator end () noexcept { return iterator (this, bits); }
+	const_iterator begin () const noexcept { return cbegin(); }
+	const_iterator end () const noexcept { return cend(); }
+	const_iterator cbegin () const noexcept { return const_iterator (this, 0); }
+	const_iterator cend () const noexcept { return const_iterator (this, bits); }
+};
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include "Vector.h"
+
+#if defined(_MSC_VER)
+#include <xmmintrin.h>
+#endif
+
+#if defined(_MSC_FULL_VER) && _MSC_FULL_VER < 180000000
+#define noexcept throw()
+#endif
+
+//default chunk of the chunked traversal: half of a typical 32 KB L1 data cache
+const size_t VECTOR_CHUNK_BYTES = 16 * 1024;
+
+namespace chunk_detail {
+	inline size_t chunkElements (size_t chunk, size_t elementSize) noexcept {
+		if (chunk) {
+			return chunk;
+		}
+		return VECTOR_CHUNK_BYTES / elementSize ? VECTOR_CHUNK_BYTES / elementSize : 1;
+	}
+
+	//software prefetch of every cache line of [ptr, ptr + bytes) for reading
+	inline void prefetchRange (const void *ptr, size_t bytes) noexcept {
+		const char *line = static_cast<const char*>(ptr);
+		for (size_t offset = 0; offset < bytes; offset += CACHE_LINE_SIZE) {
+			#if defined(__GNUC__) || defined(__clang__)
+			__builtin_prefetch(line + offset);
+			#elif defined(_MSC_VER)
+			_mm_prefetch(line + offset, _MM_HINT_T0);
+			#endif
+		}
+	}
+
+	inline void failModified () {
+		VECTOR_THROW(InvalidOperationException ("Vector was modified during chunked traversal"));
+	}
+}
+
+///<summary>
+///Raw span of a chunked traversal: [data(), data() + size()), iterated with plain pointers.
+///</summary>
+template <typename T>
+class VectorChunk {
+private:
+	T *first;
+	size_t length;
+
+public:
+	typedef T* iterator;
+
+	VectorChunk (T *first, size_t length) noexcept : first(first), length(length) { }
+
+	T* data () const noexcept { return first; }
+	size_t size () const noexcept { return length; }
+	T& operator[] (size_t index) const noexcept { return first[index]; }
+
+	T* begin () const noexcept { return first; }
+	T* end () const noexcept { return first + length; }
+};
+
+template <typename T>
+class VectorChunks;
+
+///<summary>
+///Forward iterator over the chunks of VectorChunks. Advancing checks once per chunk
+///that the vector was neither reallocated nor resized nor had elements removed (its generation() and size()), and prefetches the chunk after the next one.
+///</summary>
+template <typename T>
+class ChunkIterator {
+private:
+	const VectorChunks<T> *range;
+	size_t offset;
+
+	friend class VectorChunks<T>;
+
+	ChunkIterator (const VectorChunks<T> *range, size_t offset) noexcept : range(range), offset(offset) { }
+
+public:
+	typedef std::forward_iterator_tag iterator_category;
+	typedef VectorChunk<T> value_type;
+	typedef ptrdiff_t difference_type;
+	typedef void pointer;
+	typedef VectorChunk<T> reference;
+
+	ChunkIterator () noexcept : range(nullptr), offset(0) { }
+
+	VectorChunk<T> operator* () const noexcept {
+		size_t rest = range->count - offset;
+		return VectorChunk<T> (range->first + offset, rest < range->chunk ? rest : range->chunk);
+	}
+
+	ChunkIterator& operator++ () {
+		range->checkUnchanged();
+		offset = range->count - offset < range->chunk ? range->count : offset + range->chunk;
+		range->prefetchAfter(offset);
+		return *this;
+	}
+
+	ChunkIterator operator++ (int) { ChunkIterator clone(*this); ++*this; return clone; }
+
+	bool operator== (const ChunkIterator &another) const noexcept { return offset == another.offset && range == another.range; }
+	bool operator!= (const ChunkIterator &another) const noexcept { return !(*this == another); }
+};
+
+///<summary>
+///Range of raw chunks of a Vector, returned by Vector::chunks(). The vector is validated once, when the range is made,
+///the elements are then read through plain pointers: bounds safety at the cost of one check per chunk.
+///Modifying the size or the buffer of the vector during the traversal throws InvalidOperationException.
+///</summary>
+template <typename T>
+class VectorChunks {
+private:
+	typedef typename std::remove_const<T>::type ValueType;
+
+	const Vector<ValueType> *owner;
+	size_t generation;	//of the owner when the range was made
+	T *first;
+	size_t count;
+	size_t chunk;
+	bool prefetch;
+
+	friend class ChunkIterator<T>;
+	friend class Vector<ValueType>;
+
+	VectorChunks (const Vector<ValueType> *owner, T *first, size_t count, size_t chunk, bool prefetch)
+		: owner(owner), generation(owner->generation()), first(first), count(count), chunk(chunk), prefetch(prefetch) {
+		prefetchAfter(0);
+	}
+
+	void checkUnchanged () const {
+		if (owner->generation() != generation || owner->size() != count) {
+			chunk_detail::failModified();
+		}
+	}
+
+	//prefetches the chunk following the one at 'offset'
+	void prefetchAfter (size_t offset) const noexcept {
+		if (prefetch && count - offset > chunk) {
+			size_t next = count - offset - chunk;
+			chunk_detail::prefetchRange(first + offset + chunk, (next < chunk ? next : chunk) * sizeof(T));
+		}
+	}
+
+public:
+	typedef ChunkIterator<T> iterator;
+
+	iterator begin () const noexcept { return iterator (this, 0); }
+	iterator end () const noexcept { return iterator (this, count); }
+
+	size_t chunk_size () const noexcept { return chunk; }
+};
+
+#pragma region Vector chunks implementation
+
+template <typename T>
+template <typename Element, typename Function>
+void Vector<T>::forEachChunk (Element *first, Function &fn, size_t chunk, bool prefetch) const {
+	size_t count = size();
+	size_t expected = bufferGeneration;
+	chunk = chunk_detail::chunkElements(chunk, sizeof(T));
+
+	for (size_t offset = 0; offset < count; offset += chunk) {
+		size_t length = count - offset < chunk ? count - offset : chunk;
+		if (prefetch && count - offset > length) {
+			size_t next = count - offset - length;
+			chunk_detail::prefetchRange(first + offset + length, (next < chunk ? next : chunk) * sizeof(T));
+		}
+
+		fn(first + offset, length);
+
+		//the generation catches reallocation and removal (even when refilled to the same size), the size appends
+		if (bufferGeneration != expected || size() != count) {
+			chunk_detail::failModified();
+		}
+	}
+}
+
+template <typename T>
+template <typename Function>
+void Vector<T>::for_each_chunk (Function fn, size_t chunk, bool prefetch) {
+	forEachChunk(memory_begin, fn, chunk, prefetch);
+}
+
+template <typename T>
+template <typename Function>
+void Vector<T>::for_each_chunk (Function fn, size_t chunk, bool prefetch) const {
+	forEachChunk(static_cast<const T*>(memory_begin), fn, chunk, prefetch);
+}
+
+template <typename T>
+VectorChunks<T> Vector<T>::chunks (size_t chunk, bool prefetch) {
+	return VectorChunks<T> (this, memory_begin, size(), chunk_detail::chunkElements(chunk, sizeof(T)), prefetch);
+}
+
+template <typename T>
+VectorChunks<const T> Vector<T>::chunks (size_t chunk, bool prefetch) const {
+	return VectorChunks<const T> (this, memory_begin, size(), chunk_detail::chunkElements(chunk, sizeof(T)), prefetch);
+}
+
+#pragma endregion
@@ -0,0 +1,72 @@
+#pragma once
+
+//Language level switches shared by the Vector headers
+
+#if __cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)
+#define VECTOR_CXX20
+#endif
+
+//C++20: Vector, its iterators and their bookkeeping are usable in constant evaluation
+//(transient allocation: everything allocated must be freed before the evaluation ends).
+//DEBUG_MODE traces are not constant expressions, so compile-time vectors are not available with it.
+#ifdef VECTOR_CXX20
+#include <type_traits>
+#define VECTOR_CONSTEXPR constexpr
+#define VECTOR_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#else
+#define VECTOR_CONSTEXPR
+#define VECTOR_CONSTANT_EVALUATED() false
+#endif
+
+//'mutable' for members that const functions create on demand. GCC before 14 rejects any read of a mutable member
+//in constant evaluation, even of an object made within it, so there the members stay non-mutable in C++20
+#if defined(VECTOR_CXX20) && defined(__GNUC__) && !defined(__clang__) && __GNUC__ < 14
+#define VECTOR_LAZY_MUTABLE
+#else
+#define VECTOR_LAZY_MUTABLE mutable
+#endif
+
+//Exception-free builds (-fno-exceptions, or VECTOR_NO_EXCEPTIONS defined by hand): every failure that would throw
+//calls the failure handler with the message and aborts, try/catch cleanup blocks compile to nothing.
+//Failures that must be handled at run time go through the try_* operations of Vector, which return VectorExpected.
+#if !defined(VECTOR_NO_EXCEPTIONS) && !defined(__cpp_exceptions) && !defined(__EXCEPTIONS) && !defined(_CPPUNWIND)
+#define VECTOR_NO_EXCEPTIONS
+#endif
+
+#ifdef VECTOR_NO_EXCEPTIONS
+#include <cstdio>
+#include <cstdlib>
+
+namespace vector_detail {
+	typedef void (*FailureHandler) (const char *message);
+
+	inline FailureHandler& failureHandler () noexcept {
+		static FailureHandler handler = nullptr;
+		return handler;
+	}
+
+	template <typename Exception>
+	[[noreturn]] void fail (const Exception &exception) noexcept {
+		if (failureHandler()) {
+			failureHandler()(exception.what());
+		}
+		std::fprintf(stderr, "Vector failure: %s\n", exception.what());
+		std::abort();
+	}
+}
+
+//'handler' is called with the message of a failure before the process aborts (logging, flushing buffers)
+inline void set_vector_failure_handler (vector_detail::FailureHandler handler) noexcept {
+	vector_detail::failureHandler() = handler;
+}
+
+#define VECTOR_THROW(exception) vector_detail::fail(exception)
+#define VECTOR_TRY if (true)
+#define VECTOR_CATCH_ALL if (false)
+#define VECTOR_RETHROW
+#else
+#define VECTOR_THROW(exception) throw exception
+#define VECTOR_TRY try
+#define VECTOR_CATCH_ALL catch (...)
+#define VECTOR_RETHROW throw
+#endif
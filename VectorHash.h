@@ -0,0 +1,208 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include "Vector.h"
+
+#if defined(_MSC_FULL_VER) && _MSC_FULL_VER < 180000000
+#define noexcept throw()
+#endif
+
+//Hashing of Vector contents, so that vectors can be keys of unordered containers:
+//	std::hash<Vector<T>>	- block hash of the raw bytes when equal elements have equal bytes, element hashes otherwise
+//	HashedVector<T>			- Vector with a cached hash, invalidated by every modification
+
+namespace hash_detail {
+	const uint64_t SEED = 0xa0761d6478bd642fULL;
+	const uint64_t PRIME1 = 0xe7037ed1a0b428dbULL;
+	const uint64_t PRIME2 = 0x8ebc6af09c88c6e3ULL;
+	const uint64_t PRIME3 = 0x589965cc75374cc3ULL;
+
+	//64x64 -> 128 bit multiplication folded to 64 bits (wyhash "mum")
+	inline uint64_t mix (uint64_t a, uint64_t b) noexcept {
+		#if defined(__SIZEOF_INT128__)
+		__uint128_t product = static_cast<__uint128_t>(a) * b;
+		return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+		#else
+		uint64_t high = (a >> 32) * (b >> 32), low = (a & 0xffffffff) * (b & 0xffffffff);
+		uint64_t middle1 = (a >> 32) * (b & 0xffffffff), middle2 = (a & 0xffffffff) * (b >> 32);
+		uint64_t carry = ((low >> 32) + (middle1 & 0xffffffff) + (middle2 & 0xffffffff)) >> 32;
+		return (low + (middle1 << 32) + (middle2 << 32)) ^ (high + (middle1 >> 32) + (middle2 >> 32) + carry);
+		#endif
+	}
+
+	inline uint64_t read64 (const unsigned char *p) noexcept {
+		uint64_t value;
+		memcpy(&value, p, sizeof(value));
+		return value;
+	}
+
+	//Hash of 'bytes' bytes. The main loop consumes 32 bytes per step in four independent lanes,
+	//so the multiplications overlap and the loads vectorize.
+	inline uint64_t hashBytes (const void *data, size_t bytes, uint64_t seed = SEED) noexcept {
+		const unsigned char *p = static_cast<const unsigned char*>(data);
+		uint64_t lanes[4] = { seed, seed ^ PRIME1, seed ^ PRIME2, seed ^ PRIME3 };
+
+		size_t rest = bytes;
+		for (; rest >= 32; rest -= 32, p += 32) {
+			for (int lane = 0; lane < 4; ++lane) {
+				lanes[lane] = mix(read64(p + lane * 8) ^ PRIME1, lanes[lane] ^ PRIME2);
+			}
+		}
+
+		uint64_t h = lanes[0] ^ mix(lanes[1], PRIME1) ^ mix(lanes[2], PRIME2) ^ mix(lanes[3], PRIME3);
+		for (; rest >= 8; rest -= 8, p += 8) {
+			h = mix(read64(p) ^ PRIME1, h ^ PRIME2);
+		}
+		if (rest) {
+			uint64_t tail = 0;
+			memcpy(&tail, p, rest);
+			h = mix(tail ^ PRIME3, h ^ PRIME1);
+		}
+
+		return mix(h ^ bytes, PRIME3);
+	}
+
+	//equal values have equal bytes: the contents may be hashed as raw memory
+	template <typename T>
+	struct HasUniqueRepresentation : std::integral_constant<bool,
+		#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+		std::has_unique_object_representations<T>::value
+		#else
+		std::is_integral<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value
+		#endif
+	> { };
+
+	template <typename T>
+	size_t hashElements (const T *data, size_t count, std::true_type) noexcept {
+		return static_cast<size_t>(hashBytes(data, count * sizeof(T)));
+	}
+
+	template <typename T>
+	size_t hashElements (const T *data, size_t count, std::false_type) {
+		std::hash<T> hasher;
+		uint64_t h = SEED ^ count;
+		for (size_t i = 0; i < count; ++i) {
+			h = mix(static_cast<uint64_t>(hasher(data[i])) ^ PRIME1, h ^ PRIME2);
+		}
+		return static_cast<size_t>(h);
+	}
+}
+
+namespace std {
+	template <typename T>
+	struct hash<Vector<T>> {
+		size_t operator() (const Vector<T> &v) const {
+			return hash_detail::hashElements(v.data(), v.size(), hash_detail::HasUniqueRepresentation<T>());
+		}
+	};
+
+	//bits past size() are always zero, so the packed words are hashed as they are
+	template <>
+	struct hash<Vector<bool>> {
+		size_t operator() (const Vector<bool> &v) const noexcept {
+			return static_cast<size_t>(hash_detail::hashBytes(v.word_data(), v.word_count() * sizeof(uint64_t), hash_detail::SEED ^ v.size()));
+		}
+	};
+}
+
+template <typename T>
+class HashedVector;
+
+///<summary>
+///Access of HashedVector for modification, returned by modify(). The cached hash is dropped when the
+///modification starts and again when it ends, so a hash computed while the vector was being changed is not kept.
+///Do not keep a pointer or reference to the vector past the modification.
+///</summary>
+template <typename T>
+class HashedVectorModification {
+private:
+	HashedVector<T> *owner;
+
+	friend class HashedVector<T>;
+
+	explicit HashedVectorModification (HashedVector<T> *owner) noexcept : owner(owner) {
+		owner->hashValid = false;
+	}
+
+	#if defined(_MSC_FULL_VER) && _MSC_FULL_VER < 180000000
+	HashedVectorModification (const HashedVectorModification<T> &);
+	HashedVectorModification<T>& operator= (const HashedVectorModification<T> &);
+	#else
+	HashedVectorModification (const HashedVectorModification<T> &) = delete;
+	HashedVectorModification<T>& operator= (const HashedVectorModification<T> &) = delete;
+	#endif
+
+public:
+	HashedVectorModification (HashedVectorModification<T> &&other) noexcept : owner(other.owner) {
+		other.owner = nullptr;
+	}
+
+	~HashedVectorModification () noexcept {
+		if (owner) {
+			owner->hashValid = false;
+		}
+	}
+
+	Vector<T>& operator* () const noexcept { return owner->items; }
+	Vector<T>* operator-> () const noexcept { return &owner->items; }
+	Vector<T>& get () const noexcept { return owner->items; }
+};
+
+///<summary>
+///Vector with a cached hash for large hash map keys: the hash is computed on first use and reused
+///until the vector is changed through a modify() handle.
+///</summary>
+template <typename T>
+class HashedVector {
+private:
+	Vector<T> items;
+	mutable size_t cachedHash;
+	mutable bool hashValid;
+
+	friend class HashedVectorModification<T>;
+
+public:
+	HashedVector () : cachedHash(0), hashValid(false) { }
+	explicit HashedVector (const Vector<T> &items) : items(items), cachedHash(0), hashValid(false) { }
+	explicit HashedVector (Vector<T> &&items) : items(std::move(items)), cachedHash(0), hashValid(false) { }
+
+	const Vector<T>& get () const noexcept { return items; }
+
+	//the vector for modification until the returned handle is destroyed: modify()->push_back(x)
+	HashedVectorModification<T> modify () noexcept {
+		return HashedVectorModification<T> (this);
+	}
+
+	size_t hash () const {
+		if (!hashValid) {
+			cachedHash = std::hash<Vector<T>>()(items);
+			hashValid = true;
+		}
+		return cachedHash;
+	}
+
+	bool hash_cached () const noexcept { return hashValid; }
+
+	//different cached hashes decide without comparing the elements
+	bool operator== (const HashedVector<T> &other) const {
+		if (hashValid && other.hashValid && cachedHash != other.cachedHash) {
+			return false;
+		}
+		return items == other.items;
+	}
+
+	bool operator!= (const HashedVector<T> &other) const { return !(*this == other); }
+};
+
+namespace std {
+	template <typename T>
+	struct hash<HashedVector<T>> {
+		size_t operator() (const HashedVector<T> &v) const {
+			return v.hash();
+		}
+	};
+}
@@ -0,0 +1,261 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include "Vector.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define VECTOR_LOADER_POSIX
+#endif
+
+#if defined(_MSC_FULL_VER) && _MSC_FULL_VER < 180000000
+#define noexcept throw()
+#endif
+
+const size_t DEFAULT_LOAD_CHUNK_BYTES = 4 * 1024 * 1024;
+
+struct LoadException : public std::exception {
+	std::string message;
+
+	explicit LoadException (const std::string &msg) : message(msg) { }
+
+	const char* what () const noexcept override {
+		return message.c_str();
+	}
+};
+
+///<summary>
+///Appends the records of a binary file (an array of trivially copyable T) to a Vector.
+///The vector is reserved once from the file size, and the file is read straight into its storage.
+///Without a transform the file is read with large pread calls. With a transform, a reader thread
+///stays at most two chunks ahead of the caller's thread, which transforms each chunk
+///while the next one is being read, so I/O overlaps with the processing.
+///Records become visible in the vector only when the whole file was loaded:
+///on any error the vector keeps its old contents and LoadException is thrown.
+///</summary>
+template <typename T>
+class VectorLoader {
+private:
+	static_assert(std::is_trivially_copyable<T>::value, "VectorLoader reads raw bytes: T must be trivially copyable");
+
+	size_t chunkRecords;
+
+	#ifdef VECTOR_LOADER_POSIX
+	//closes the descriptor on scope exit
+	struct FileDescriptor {
+		int fd;
+		explicit FileDescriptor (int fd) : fd(fd) { }
+		~FileDescriptor () { if (fd >= 0) { close(fd); } }
+	};
+
+	//reads exactly 'bytes' bytes at 'offset'
+	static void readFully (int fd, char *target, size_t bytes, off_t offset, const std::string &path) {
+		while (bytes > 0) {
+			ssize_t got = pread(fd, target, bytes, offset);
+			if (got < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				VECTOR_THROW(LoadException ("Cannot read " + path));
+			}
+			if (got == 0) {
+				VECTOR_THROW(LoadException ("Unexpected end of file " + path));
+			}
+			target += got;
+			bytes -= static_cast<size_t>(got);
+			offset += got;
+		}
+	}
+
+	static size_t recordsIn (int fd, const std::string &path) {
+		struct stat info;
+		if (fstat(fd, &info) != 0) {
+			VECTOR_THROW(LoadException ("Cannot stat " + path));
+		}
+		size_t bytes = static_cast<size_t>(info.st_size);
+		if (bytes % sizeof(T)) {
+			VECTOR_THROW(LoadException ("Size of " + path + " is not a multiple of the record size"));
+		}
+		return bytes / sizeof(T);
+	}
+
+	//reader thread: chunk after chunk into 'target', at most two chunks ahead of the transform
+	template <typename Transform>
+	void pipeline (int fd, T *target, size_t count, const std::string &path, Transform &transform) const {
+		size_t chunks = (count + chunkRecords - 1) / chunkRecords;
+		size_t chunksRead = 0;
+		size_t chunksTransformed = 0;
+		bool failed = false;
+		std::exception_ptr readError;
+		std::mutex mutex;
+		std::condition_variable changed;
+
+		std::thread reader([&]() {
+			VECTOR_TRY {
+				for (size_t chunk = 0; chunk < chunks; ++chunk) {
+					{
+						std::unique_lock<std::mutex> lock(mutex);
+						changed.wait(lock, [&]() { return failed || chunk < chunksTransformed + 2; });
+						if (failed) {
+							return;
+						}
+					}
+
+					size_t first = chunk * chunkRecords;
+					size_t records = count - first < chunkRecords ? count - first : chunkRecords;
+					readFully(fd, reinterpret_cast<char*>(target + first), records * sizeof(T), static_cast<off_t>(first * sizeof(T)), path);
+
+					std::lock_guard<std::mutex> lock(mutex);
+					++chunksRead;
+					changed.notify_all();
+				}
+			}
+			VECTOR_CATCH_ALL {
+				std::lock_guard<std::mutex> lock(mutex);
+				readError = std::current_exception();
+				failed = true;
+				changed.notify_all();
+			}
+		});
+
+		std::exception_ptr transformError;
+		for (size_t chunk = 0; chunk < chunks; ++chunk) {
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				changed.wait(lock, [&]() { return failed || chunk < chunksRead; });
+				if (failed) {
+					break;
+				}
+			}
+
+			size_t first = chunk * chunkRecords;
+			size_t records = count - first < chunkRecords ? count - first : chunkRecords;
+			VECTOR_TRY {
+				transform(target + first, records);
+			}
+			VECTOR_CATCH_ALL {
+				transformError = std::current_exception();
+			}
+
+			std::lock_guard<std::mutex> lock(mutex);
+			if (transformError) {
+				failed = true;
+			}
+			else {
+				++chunksTransformed;
+			}
+			changed.notify_all();
+			if (failed) {
+				break;
+			}
+		}
+
+		reader.join();
+
+		if (readError) {
+			std::rethrow_exception(readError);
+		}
+		if (transformError) {
+			std::rethrow_exception(transformError);
+		}
+	}
+	#endif
+
+	struct NoTransform {
+		void operator() (T*, size_t) const noexcept { }
+	};
+
+	template <typename Transform>
+	size_t load (const std::string &path, Vector<T> &out, Transform &transform, bool transformed) const;
+
+public:
+	explicit VectorLoader (size_t chunkBytes = DEFAULT_LOAD_CHUNK_BYTES)
+		: chunkRecords(chunkBytes / sizeof(T) ? chunkBytes / sizeof(T) : 1) { }
+
+	//appends all records of the file to 'out', returns their number
+	size_t load (const std::string &path, Vector<T> &out) const {
+		NoTransform transform;
+		return load(path, out, transform, false);
+	}
+
+	//the same, 'transform(T *records, size_t count)' is called on every chunk after it was read (on the caller's thread)
+	template <typename Transform>
+	size_t load (const std::string &path, Vector<T> &out, Transform transform) const {
+		return load(path, out, transform, true);
+	}
+};
+
+template <typename T>
+template <typename Transform>
+size_t VectorLoader<T>::load (const std::string &path, Vector<T> &out, Transform &transform, bool transformed) const {
+	#ifdef VECTOR_LOADER_POSIX
+	FileDescriptor file(open(path.c_str(), O_RDONLY));
+	if (file.fd < 0) {
+		VECTOR_THROW(LoadException ("Cannot open " + path));
+	}
+
+	size_t count = recordsIn(file.fd, path);
+	out.reserve(out.size() + count);
+	T *target = out.uninitializedEnd();
+
+	#if defined(__linux__)
+	posix_fadvise(file.fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+	#endif
+
+	if (transformed && count > chunkRecords) {
+		pipeline(file.fd, target, count, path, transform);
+	}
+	else {
+		for (size_t first = 0; first < count; first += chunkRecords) {
+			size_t records = count - first < chunkRecords ? count - first : chunkRecords;
+			readFully(file.fd, reinterpret_cast<char*>(target + first), records * sizeof(T), static_cast<off_t>(first * sizeof(T)), path);
+			transform(target + first, records);
+		}
+	}
+	#else
+	std::FILE *file = std::fopen(path.c_str(), "rb");
+	if (!file) {
+		VECTOR_THROW(LoadException ("Cannot open " + path));
+	}
+
+	size_t count;
+	T *target;
+	VECTOR_TRY {
+		std::fseek(file, 0, SEEK_END);
+		long bytes = std::ftell(file);
+		std::fseek(file, 0, SEEK_SET);
+		if (bytes < 0 || static_cast<size_t>(bytes) % sizeof(T)) {
+			VECTOR_THROW(LoadException ("Size of " + path + " is not a multiple of the record size"));
+		}
+		count = static_cast<size_t>(bytes) / sizeof(T);
+		out.reserve(out.size() + count);
+		target = out.uninitializedEnd();
+
+		for (size_t first = 0; first < count; first += chunkRecords) {
+			size_t records = count - first < chunkRecords ? count - first : chunkRecords;
+			if (std::fread(target + first, sizeof(T), records, file) != records) {
+				VECTOR_THROW(LoadException ("Cannot read " + path));
+			}
+			transform(target + first, records);
+		}
+	}
+	VECTOR_CATCH_ALL {
+		std::fclose(file);
+		VECTOR_RETHROW;
+	}
+	std::fclose(file);
+	#endif
+
+	out.commitAppended(count);
+	return count;
+}
@@ -0,0 +1,108 @@
+//Build check for exception-free builds: instantiates every container with exceptions disabled.
+//Not a test: it only has to compile and run without failures, e.g.
+//g++ -std=c++11 -fno-exceptions -pthread VectorNoExceptions.cpp -o VectorNoExceptions
+//Usage: VectorNoExceptions [file of int32 records to load]
+
+#include "Vector.h"
+#include "FlatSet.h"
+#include "FlatMap.h"
+#include "PackedIntVector.h"
+#include "VectorSort.h"
+#include "RingVector.h"
+#include "VectorLoader.h"
+#include "StaticVector.h"
+#include "VectorHash.h"
+#include "SharedVector.h"
+#include "PersistentVector.h"
+#include "RcuVector.h"
+#include "SizingHints.h"
+#include <cstdio>
+#include <functional>
+
+#ifndef VECTOR_NO_EXCEPTIONS
+#error "build this file with exceptions disabled (-fno-exceptions)"
+#endif
+
+int main (int argc, char **argv) {
+	Vector<int> v;
+	for (int i = 0; i < 100; ++i) {
+		v.push_back(100 - i);
+	}
+	v.try_push_back(0);
+	v.try_reserve(1000);
+	Vector<int> filled(10, 7);
+	Vector<Vector<int>> nested;
+	nested.push_back(v);
+	nested.push_back(std::move(filled));
+	size_t sum = 0;
+	for (int value : v.checked()) {
+		sum += static_cast<size_t>(value);
+	}
+	v.for_each_chunk([&sum](int *data, size_t count) { sum += count + static_cast<size_t>(data[0]); });
+	VectorView<int> view = v.view(10, 20, 2);
+	sum += static_cast<size_t>(view[1]);
+
+	Vector<bool> bits(70, true);
+	bits.push_back(false);
+
+	StaticVector<int, 8> fixed;
+	fixed.push_back(1);
+	RingVector<int> ring;
+	for (int i = 0; i < 20; ++i) {
+		ring.push_back(i);
+		if (i % 3 == 0) {
+			ring.pop_front();
+		}
+	}
+
+	FlatSet<int> set;
+	set.insert(v.begin(), v.end());
+	FlatMap<int, Vector<int>> map;
+	map.insert(1, v);
+	map[2].push_back(3);
+	sum += map.at(1).size();
+
+	PackedIntVector packed (v);
+	sum += static_cast<size_t>(packed[3]);
+
+	Vector<int> sorted(v);
+	radix_sort(sorted);
+	parallel_sort(nested, [](const Vector<int> &a, const Vector<int> &b) { return a.size() < b.size(); }, 2);
+
+	sum += std::hash<Vector<int>>()(v) & 1;
+	HashedVector<int> hashed (v);
+	sum += hashed.hash() & 1;
+
+	PersistentVector<int> persistent (v);
+	persistent = persistent.push_back(1).set(0, 2);
+	TransientVector<int> transient = persistent.transient();
+	transient.push_back(3);
+	sum += transient.persistent().to_vector().size();
+
+	RcuVector<int> published (v);
+	published.update([](Vector<int> &items) { items.push_back(1); });
+	{
+		RcuReadGuard<int> guard = published.read();
+		sum += guard->size();
+	}
+	published.synchronize();
+
+	#ifdef SHARED_VECTOR_POSIX
+	SharedVector<int> shared = SharedVector<int>::anonymous(16, 1);
+	shared.begin_batch();
+	shared.push_back(1);
+	shared.publish();
+	#endif
+
+	SizingHint hint;
+	Vector<int> hinted (hint);
+	hinted.push_back(1);
+
+	if (argc > 1) {
+		Vector<int32_t> loaded;
+		sum += VectorLoader<int32_t>().load(argv[1], loaded);
+	}
+
+	std::printf("%zu %zu %zu %zu %zu\n", sum, bits.size(), fixed.size(), ring.size(), set.size());
+	return 0;
+}
@@ -0,0 +1,304 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include "Vector.h"
+#include "VectorStorage.h"
+
+#if defined(_MSC_FULL_VER) && _MSC_FULL_VER < 180000000
+#define noexcept throw()
+#endif
+
+//Sorting of Vector contents on raw storage, without the checked iterators:
+//	radix_sort(v)			- LSD radix sort of integer and floating point elements
+//	radix_sort(v, key)		- stable LSD radix sort of any elements by an integer or floating point key
+//	parallel_sort(v, less)	- chunks sorted on separate threads, then merged pairwise in parallel
+//	sort(v[, less])			- radix sort where it applies, parallel sort otherwise
+
+namespace sort_detail {
+	const size_t RADIX_BITS = 8;
+	const size_t RADIX_BUCKETS = 1 << RADIX_BITS;
+
+	//below this size the parallel sort does not start threads
+	const size_t PARALLEL_SORT_THRESHOLD = 1 << 16;
+
+	//Maps an arithmetic key to an unsigned integer of the same order
+	template <typename T, typename Enable = void>
+	struct RadixKey { };
+
+	template <typename T>
+	struct RadixKey<T, typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value && !std::is_same<T, bool>::value>::type> {
+		typedef T type;
+		static type get (T value) noexcept { return value; }
+	};
+
+	template <typename T>
+	struct RadixKey<T, typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type> {
+		typedef typename std::make_unsigned<T>::type type;
+		static type get (T value) noexcept {
+			return static_cast<type>(value) ^ (type(1) << (sizeof(type) * 8 - 1));
+		}
+	};
+
+	//negative numbers: all bits inverted, positive ones: sign bit set
+	template <typename T>
+	struct RadixKey<T, typename std::enable_if<std::is_floating_point<T>::value && (sizeof(T) == 4 || sizeof(T) == 8)>::type> {
+		typedef typename std::conditional<sizeof(T) == 4, uint32_t, uint64_t>::type type;
+		static type get (T value) noexcept {
+			type bits;
+			memcpy(&bits, &value, sizeof(bits));
+			type sign = type(1) << (sizeof(type) * 8 - 1);
+			return (bits & sign) ? ~bits : (bits | sign);
+		}
+	};
+
+	template <typename T, typename Enable = void>
+	struct HasRadixKey : std::false_type { };
+
+	template <typename T>
+	struct HasRadixKey<T, typename std::conditional<false, typename RadixKey<T>::type, void>::type> : std::true_type { };
+
+	//uninitialized buffer for 'count' trivially copyable items
+	template <typename Item>
+	class ScratchBuffer {
+	private:
+		Item *items;
+		size_t bytes;
+
+		ScratchBuffer (const ScratchBuffer &);
+		ScratchBuffer& operator= (const ScratchBuffer &);
+
+	public:
+		explicit ScratchBuffer (size_t count) : items(nullptr), bytes(count * sizeof(Item)) {
+			if (bytes) {
+				items = static_cast<Item*>(allocateStorage(bytes, StorageOptions()));
+			}
+		}
+
+		~ScratchBuffer () {
+			if (items) {
+				deallocateStorage(items, bytes, StorageOptions());
+			}
+		}
+
+		Item* get () const noexcept { return items; }
+	};
+
+	//Stable LSD radix sort of trivially copyable items by 'keyOf(item)' (an unsigned integer), 8 bits per pass.
+	//All histograms are built in one read pass, passes whose digit is the same for every item are skipped.
+	template <typename Item, typename KeyOf>
+	void radixSort (Item *data, size_t count, const KeyOf &keyOf) {
+		typedef decltype(keyOf(*data)) Key;
+		const size_t passes = sizeof(Key) * 8 / RADIX_BITS;
+
+		if (count < 2) {
+			return;
+		}
+
+		size_t histograms[sizeof(Key) * 8 / RADIX_BITS][RADIX_BUCKETS];
+		memset(histograms, 0, sizeof(histograms));
+		for (size_t i = 0; i < count; ++i) {
+			Key key = keyOf(data[i]);
+			for (size_t pass = 0; pass < passes; ++pass) {
+				++histograms[pass][(key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)];
+			}
+		}
+
+		ScratchBuffer<Item> scratch(count);
+		Item *from = data;
+		Item *to = scratch.get();
+
+		for (size_t pass = 0; pass < passes; ++pass) {
+			size_t *histogram = histograms[pass];
+			size_t shift = pass * RADIX_BITS;
+
+			if (histogram[(keyOf(data[0]) >> shift) & (RADIX_BUCKETS - 1)] == count) {
+				continue;
+			}
+
+			size_t offsets[RADIX_BUCKETS];
+			size_t sum = 0;
+			for (size_t bucket = 0; bucket < RADIX_BUCKETS; ++bucket) {
+				offsets[bucket] = sum;
+				sum += histogram[bucket];
+			}
+
+			for (size_t i = 0; i < count; ++i) {
+				to[offsets[(keyOf(from[i]) >> shift) & (RADIX_BUCKETS - 1)]++] = from[i];
+			}
+			std::swap(from, to);
+		}
+
+		if (from != data) {
+			memcpy(data, from, count * sizeof(Item));
+		}
+	}
+
+	template <typename T>
+	struct ElementKey {
+		typename RadixKey<T>::type operator() (const T &value) const noexcept { return RadixKey<T>::get(value); }
+	};
+
+	template <typename Key>
+	struct KeyedIndex {
+		Key key;
+		size_t index;
+	};
+
+	template <typename Key>
+	struct KeyedIndexKey {
+		Key operator() (const KeyedIndex<Key> &item) const noexcept { return item.key; }
+	};
+
+	//Sorts [data, data + count) with 'threads' threads: equal chunks are sorted concurrently,
+	//then neighbouring runs are merged pairwise, each round on half as many threads.
+	//An exception thrown by the comparison on any thread is rethrown by the caller.
+	template <typename T, typename Less>
+	void parallelSort (T *data, size_t count, const Less &less, size_t threads) {
+		if (threads < 2 || count < PARALLEL_SORT_THRESHOLD) {
+			std::sort(data, data + count, less);
+			return;
+		}
+
+		Vector<size_t> bounds;
+		for (size_t i = 0; i <= threads; ++i) {
+			bounds.push_back(count / threads * i + (i == threads ? count % threads : 0));
+		}
+
+		Vector<std::exception_ptr> errors;
+		for (size_t i = 0; i < threads; ++i) {
+			errors.push_back(std::exception_ptr());
+		}
+
+		//runs task(i) for i in [0, tasks) on separate threads, then rethrows the first error
+		auto runAll = [&errors](size_t tasks, const std::function<void (size_t)> &task) {
+			//reserved up front: push_back cannot fail while holding a started thread
+			Vector<std::thread> workers;
+			workers.reserve(tasks);
+			VECTOR_TRY {
+				for (size_t i = 0; i < tasks; ++i) {
+					workers.push_back(std::thread([&errors, &task, i]() {
+						VECTOR_TRY {
+							task(i);
+						}
+						VECTOR_CATCH_ALL {
+							errors[i] = std::current_exception();
+						}
+					}));
+				}
+			}
+			VECTOR_CATCH_ALL {
+				//a thread could not be started: the started ones must be joined before they are destroyed
+				for (size_t i = 0; i < workers.size(); ++i) {
+					workers[i].join();
+				}
+				VECTOR_RETHROW;
+			}
+			for (size_t i = 0; i < tasks; ++i) {
+				workers[i].join();
+			}
+			for (size_t i = 0; i < tasks; ++i) {
+				if (errors[i]) {
+					std::rethrow_exception(errors[i]);
+				}
+			}
+		};
+
+		runAll(threads, [&](size_t i) {
+			std::sort(data + bounds[i], data + bounds[i + 1], less);
+		});
+
+		for (size_t width = 1; width < threads; width *= 2) {
+			size_t pairs = (threads + 2 * width - 1) / (2 * width);
+			runAll(pairs, [&, width](size_t pair) {
+				size_t first = pair * 2 * width;
+				size_t middle = std::min(first + width, threads);
+				size_t last = std::min(first + 2 * width, threads);
+				if (middle < last) {
+					std::inplace_merge(data + bounds[first], data + bounds[middle], data + bounds[last], less);
+				}
+			});
+		}
+	}
+
+	inline size_t defaultThreads () noexcept {
+		unsigned hardware = std::thread::hardware_concurrency();
+		return hardware ? hardware : 1;
+	}
+}
+
+///<summary>
+///LSD radix sort of integer or floating point elements in ascending order (NaNs go to the ends).
+///</summary>
+template <typename T>
+typename std::enable_if<sort_detail::HasRadixKey<T>::value>::type radix_sort (Vector<T> &v) {
+	sort_detail::radixSort(v.data(), v.size(), sort_detail::ElementKey<T>());
+}
+
+///<summary>
+///Stable sort by 'key(element)', an integer or floating point value: the keys are radix sorted
+///together with element indices, then the elements are moved to their places once.
+///</summary>
+template <typename T, typename KeyFunction>
+void radix_sort (Vector<T> &v, const KeyFunction &key) {
+	typedef typename std::decay<decltype(key(*v.data()))>::type KeyType;
+	typedef typename sort_detail::RadixKey<KeyType>::type Key;
+
+	T *data = v.data();
+	size_t count = v.size();
+
+	Vector<sort_detail::KeyedIndex<Key>> order;
+	order.reserve(count);
+	for (size_t i = 0; i < count; ++i) {
+		sort_detail::KeyedIndex<Key> item;
+		item.key = sort_detail::RadixKey<KeyType>::get(key(data[i]));
+		item.index = i;
+		order.push_back(item);
+	}
+
+	sort_detail::radixSort(order.data(), count, sort_detail::KeyedIndexKey<Key>());
+
+	Vector<T> sorted(v.storage_options());
+	sorted.reserve(count);
+	for (size_t i = 0; i < count; ++i) {
+		sorted.push_back(std::move(data[order.data()[i].index]));
+	}
+	v.swap(sorted);
+}
+
+///<summary>
+///Comparison sort of the elements on 'threads' threads (by default one per hardware thread).
+///Not stable.
+///</summary>
+template <typename T, typename Less>
+void parallel_sort (Vector<T> &v, const Less &less, size_t threads = sort_detail::defaultThreads()) {
+	sort_detail::parallelSort(v.data(), v.size(), less, threads);
+}
+
+template <typename T>
+void parallel_sort (Vector<T> &v) {
+	parallel_sort(v, std::less<T>());
+}
+
+//ascending order: radix sort for arithmetic types, parallel sort for the others
+template <typename T>
+typename std::enable_if<sort_detail::HasRadixKey<T>::value>::type sort (Vector<T> &v) {
+	radix_sort(v);
+}
+
+template <typename T>
+typename std::enable_if<!sort_detail::HasRadixKey<T>::value>::type sort (Vector<T> &v) {
+	parallel_sort(v);
+}
+
+template <typename T, typename Less>
+void sort (Vector<T> &v, const Less &less) {
+	parallel_sort(v, less);
+}
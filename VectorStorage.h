@@ -0,0 +1,297 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include "VectorConfig.h"
+#include "BufferRecycler.h"
+
+#ifdef MEMORY_TRACE_MODE
+#include "MemoryWatcher.h"
+#endif
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#elif defined(_MSC_VER)
+#include <malloc.h>
+#endif
+
+#if defined(_MSC_FULL_VER) && _MSC_FULL_VER < 180000000
+#define noexcept throw()
+#endif
+
+const size_t CACHE_LINE_SIZE = 64;
+const size_t SMALL_PAGE_SIZE = 4096;
+const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+const size_t DEFAULT_MMAP_THRESHOLD = 64 * 1024 * 1024;
+
+///<summary>
+///Describes how a vector obtains its raw buffer.
+///Default options use plain malloc, so that buffers of trivially copyable elements can be realloc'ed,
+///and anonymous mappings resized with mremap for buffers above DEFAULT_MMAP_THRESHOLD on Linux.
+///</summary>
+struct StorageOptions {
+	size_t alignment;			//required buffer alignment in bytes, 0 means default operator new[] alignment
+	size_t hugePageThreshold;	//buffers of at least this many bytes are advised to use huge pages, 0 disables
+	bool lockMemory;			//mlock the buffer (best effort, may be limited by RLIMIT_MEMLOCK)
+	bool prefault;				//touch every page right after allocation
+	size_t mmapThreshold;		//Linux: buffers of at least this many bytes are anonymous mappings resized with mremap, 0 disables
+	bool recycle;				//plain buffers are taken from and returned to the thread's BufferRecycler
+
+	VECTOR_CONSTEXPR StorageOptions () : alignment(0), hugePageThreshold(0), lockMemory(false), prefault(false), mmapThreshold(DEFAULT_MMAP_THRESHOLD), recycle(false) { }
+
+	static StorageOptions cacheAligned () {
+		StorageOptions options;
+		options.alignment = CACHE_LINE_SIZE;
+		return options;
+	}
+
+	static StorageOptions pageAligned () {
+		StorageOptions options;
+		options.alignment = SMALL_PAGE_SIZE;
+		return options;
+	}
+
+	//page aligned, huge pages above the threshold, locked and prefaulted
+	static StorageOptions latencyCritical (size_t hugePageThreshold = HUGE_PAGE_SIZE) {
+		StorageOptions options;
+		options.alignment = SMALL_PAGE_SIZE;
+		options.hugePageThreshold = hugePageThreshold;
+		options.lockMemory = true;
+		options.prefault = true;
+		return options;
+	}
+
+	//buffers below mmapThreshold are cached by the BufferRecycler of the releasing thread
+	static StorageOptions recycled () {
+		StorageOptions options;
+		options.recycle = true;
+		return options;
+	}
+
+	//plain malloc storage for buffers below mmapThreshold
+	bool isDefault () const noexcept {
+		return alignment == 0 && hugePageThreshold == 0 && !lockMemory && !prefault && !recycle;
+	}
+};
+
+namespace storage_detail {
+	inline bool useHugePages (size_t bytes, const StorageOptions &options) noexcept {
+		return options.hugePageThreshold != 0 && bytes >= options.hugePageThreshold;
+	}
+
+	//alignment actually used for the given request
+	inline size_t effectiveAlignment (size_t bytes, const StorageOptions &options) noexcept {
+		size_t alignment = options.alignment;
+		if (useHugePages(bytes, options) && alignment < HUGE_PAGE_SIZE) {
+			alignment = HUGE_PAGE_SIZE; //transparent huge pages are only used for 2M-aligned ranges
+		}
+		if (alignment < sizeof(void*)) {
+			alignment = sizeof(void*);
+		}
+		return alignment;
+	}
+
+	//size actually requested from the system: huge page buffers are padded to a whole huge page
+	inline size_t effectiveSize (size_t bytes, const StorageOptions &options) noexcept {
+		if (useHugePages(bytes, options)) {
+			return (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+		}
+		return bytes;
+	}
+
+	inline void* alignedAllocate (size_t bytes, size_t alignment) {
+		void *ptr = nullptr;
+
+		#if defined(_MSC_VER)
+		ptr = _aligned_malloc(bytes ? bytes : 1, alignment);
+		#else
+		if (posix_memalign(&ptr, alignment, bytes ? bytes : 1) != 0) {
+			ptr = nullptr;
+		}
+		#endif
+
+		if (!ptr) {
+			VECTOR_THROW(std::bad_alloc());
+		}
+		return ptr;
+	}
+
+	inline void alignedDeallocate (void *ptr) noexcept {
+		#if defined(_MSC_VER)
+		_aligned_free(ptr);
+		#else
+		free(ptr);
+		#endif
+	}
+
+	inline void prefaultPages (void *ptr, size_t bytes) noexcept {
+		volatile char *page = static_cast<volatile char*>(ptr);
+		for (size_t offset = 0; offset < bytes; offset += SMALL_PAGE_SIZE) {
+			page[offset] = 0;
+		}
+	}
+
+	//applies huge page advice, locking and prefaulting to [ptr, ptr + size), a buffer requested for 'bytes' bytes
+	inline void adviseStorage (void *ptr, size_t size, size_t bytes, const StorageOptions &options) noexcept {
+		#if defined(__linux__)
+		#ifdef MADV_HUGEPAGE
+		if (useHugePages(bytes, options)) {
+			madvise(ptr, size, MADV_HUGEPAGE); //only an advice: ignoring failure
+		}
+		#endif
+		if (options.lockMemory && size) {
+			mlock(ptr, size); //best effort: RLIMIT_MEMLOCK may forbid it
+		}
+		#endif
+
+		if (options.prefault) {
+			prefaultPages(ptr, size);
+		}
+	}
+
+	#if defined(__linux__) && defined(MREMAP_MAYMOVE)
+	//mapped buffers are only page aligned
+	inline bool useMemoryMapping (size_t bytes, const StorageOptions &options) noexcept {
+		return options.mmapThreshold != 0 && bytes >= options.mmapThreshold && options.alignment <= SMALL_PAGE_SIZE;
+	}
+
+	inline size_t mappedSize (size_t bytes) noexcept {
+		return (bytes + SMALL_PAGE_SIZE - 1) / SMALL_PAGE_SIZE * SMALL_PAGE_SIZE;
+	}
+
+	inline void* mapStorage (size_t bytes, const StorageOptions &options) {
+		size_t size = mappedSize(bytes);
+		void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (ptr == MAP_FAILED) {
+			VECTOR_THROW(std::bad_alloc());
+		}
+
+		adviseStorage(ptr, size, bytes, options);
+		return ptr;
+	}
+
+	inline void unmapStorage (void *ptr, size_t bytes) noexcept {
+		munmap(ptr, mappedSize(bytes)); //also unlocks the pages
+	}
+
+	//page tables are moved by the kernel: no byte is copied
+	inline void* remapStorage (void *ptr, size_t oldBytes, size_t newBytes, const StorageOptions &options) {
+		size_t oldSize = mappedSize(oldBytes);
+		size_t newSize = mappedSize(newBytes);
+		void *result = mremap(ptr, oldSize, newSize, MREMAP_MAYMOVE);
+		if (result == MAP_FAILED) {
+			VECTOR_THROW(std::bad_alloc());
+		}
+
+		if (newSize > oldSize) { //the tail is a fresh range
+			adviseStorage(static_cast<char*>(result) + oldSize, newSize - oldSize, newBytes, options);
+		}
+		return result;
+	}
+	#else
+	inline bool useMemoryMapping (size_t, const StorageOptions &) noexcept { return false; }
+	inline void* mapStorage (size_t, const StorageOptions &) { VECTOR_THROW(std::bad_alloc()); }
+	inline void unmapStorage (void *, size_t) noexcept { }
+	inline void* remapStorage (void *, size_t, size_t, const StorageOptions &) { VECTOR_THROW(std::bad_alloc()); }
+	#endif
+
+	//recycled buffers are plain malloc buffers of their size class: any other option turns recycling off
+	inline bool useRecycler (size_t bytes, const StorageOptions &options) noexcept {
+		return options.recycle && options.alignment == 0 && options.hugePageThreshold == 0 && !options.lockMemory && !options.prefault
+			&& !useMemoryMapping(bytes, options);
+	}
+}
+
+//Allocates raw (uninitialized) memory for 'bytes' bytes according to 'options'.
+//Throws std::bad_alloc on failure, just like operator new[].
+inline void* allocateStorage (size_t bytes, const StorageOptions &options) {
+	#ifdef MEMORY_TRACE_MODE
+	watcher.onStorageAllocated ();
+	#endif
+
+	if (storage_detail::useMemoryMapping(bytes, options)) {
+		return storage_detail::mapStorage(bytes, options);
+	}
+	if (storage_detail::useRecycler(bytes, options)) {
+		return BufferRecycler::acquireLocal(bytes);
+	}
+	if (options.isDefault()) {
+		void *ptr = malloc(bytes ? bytes : 1);
+		if (!ptr) {
+			VECTOR_THROW(std::bad_alloc());
+		}
+		return ptr;
+	}
+
+	size_t size = storage_detail::effectiveSize(bytes, options);
+	void *ptr = storage_detail::alignedAllocate(size, storage_detail::effectiveAlignment(bytes, options));
+
+	storage_detail::adviseStorage(ptr, size, bytes, options);
+
+	return ptr;
+}
+
+//Frees memory obtained by allocateStorage with the same 'bytes' and 'options'.
+inline void deallocateStorage (void *ptr, size_t bytes, const StorageOptions &options) noexcept {
+	if (!ptr) {
+		return;
+	}
+	if (storage_detail::useMemoryMapping(bytes, options)) {
+		storage_detail::unmapStorage(ptr, bytes);
+		return;
+	}
+	if (storage_detail::useRecycler(bytes, options)) {
+		BufferRecycler::releaseLocal(ptr, bytes);
+		return;
+	}
+	if (options.isDefault()) {
+		free(ptr);
+		return;
+	}
+
+	#if defined(__linux__)
+	if (options.lockMemory && bytes) {
+		munlock(ptr, storage_detail::effectiveSize(bytes, options));
+	}
+	#endif
+
+	storage_detail::alignedDeallocate(ptr);
+}
+
+//Resizes a buffer holding trivially relocatable data: the first min(oldBytes, newBytes) bytes are kept.
+//Mapped storage is resized with mremap, default storage with realloc (both in place when possible),
+//other storage (recycled buffers too) is copied with memcpy.
+//'ptr' may be null. On failure throws std::bad_alloc and leaves the old buffer untouched.
+inline void* reallocateStorage (void *ptr, size_t oldBytes, size_t newBytes, const StorageOptions &options) {
+	if (!ptr) {
+		return allocateStorage (newBytes, options);
+	}
+
+	bool oldMapped = storage_detail::useMemoryMapping(oldBytes, options);
+	bool newMapped = storage_detail::useMemoryMapping(newBytes, options);
+
+	if (oldMapped && newMapped) {
+		return storage_detail::remapStorage(ptr, oldBytes, newBytes, options);
+	}
+
+	if (!oldMapped && !newMapped && options.isDefault()) {
+		#ifdef MEMORY_TRACE_MODE
+		watcher.onStorageAllocated ();
+		#endif
+
+		void *result = realloc(ptr, newBytes ? newBytes : 1);
+		if (!result) {
+			VECTOR_THROW(std::bad_alloc());
+		}
+		return result;
+	}
+
+	void *result = allocateStorage (newBytes, options);
+	memcpy(result, ptr, oldBytes < newBytes ? oldBytes : newBytes);
+	deallocateStorage (ptr, oldBytes, options);
+	return result;
+}
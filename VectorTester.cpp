@@ -1,14 +1,40 @@
 #define MEMORY_TRACE_MODE
+#define VIEW_CHECK_MODE
 //#define DEBUG_MODE
 
 #include "MemoryWatcher.h"
 #include "Vector.h"
+#include "FlatSet.h"
+#include "FlatMap.h"
+#include "PackedIntVector.h"
+#include "VectorSort.h"
+#include "RingVector.h"
+#include "VectorLoader.h"
+#include "StaticVector.h"
+#include "VectorHash.h"
+#include "SharedVector.h"
+#include "PersistentVector.h"
+#include "RcuVector.h"
 #include <string>
 #include <iostream>
 #include <vector>
 #include <functional>
 #include <cstdlib>
 #include <list>
+#include <algorithm>
+#include <set>
+#include <unordered_map>
+#include <map>
+#include <deque>
+#include <cstdio>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <thread>
+#ifdef SHARED_VECTOR_POSIX
+#include <sys/wait.h>
+#endif
 
 using namespace std;
 
@@ -59,6 +85,101 @@ public:
 
 #pragma region utility
 
+//Every form of the global operator new is replaced and counted, see testStaticVector.
+//The deletes are replaced as well, so that every block is freed the way it was allocated.
+atomic<size_t> heapAllocations(0);
+
+//kept out of line: a free() inlined into a delete expression makes GCC warn about new/free mismatches
+#if defined(__GNUC__)
+#define TESTER_NOINLINE __attribute__((noinline))
+#else
+#define TESTER_NOINLINE
+#endif
+
+void* countedAllocate (size_t size) noexcept {
+	++heapAllocations;
+	return malloc(size ? size : 1);
+}
+
+TESTER_NOINLINE void countedFree (void *memory) noexcept {
+	free(memory);
+}
+
+#ifdef __cpp_aligned_new
+//over-aligned blocks keep the pointer returned by malloc just before the aligned address
+void* countedAllocate (size_t size, align_val_t alignment) noexcept {
+	++heapAllocations;
+	size_t bytes = static_cast<size_t>(alignment);
+	void *raw = malloc(size + bytes + sizeof(void*));
+	if (!raw) {
+		return nullptr;
+	}
+	uintptr_t aligned = (reinterpret_cast<uintptr_t>(raw) + sizeof(void*) + bytes - 1) & ~static_cast<uintptr_t>(bytes - 1);
+	reinterpret_cast<void**>(aligned)[-1] = raw;
+	return reinterpret_cast<void*>(aligned);
+}
+
+TESTER_NOINLINE void countedFree (void *memory, align_val_t) noexcept {
+	if (memory) {
+		free(static_cast<void**>(memory)[-1]);
+	}
+}
+#endif
+
+void* operator new (size_t size) {
+	void *memory = countedAllocate(size);
+	if (!memory) {
+		throw bad_alloc();
+	}
+	return memory;
+}
+
+void* operator new[] (size_t size) {
+	void *memory = countedAllocate(size);
+	if (!memory) {
+		throw bad_alloc();
+	}
+	return memory;
+}
+
+void* operator new (size_t size, const nothrow_t &) noexcept { return countedAllocate(size); }
+void* operator new[] (size_t size, const nothrow_t &) noexcept { return countedAllocate(size); }
+
+void operator delete (void *memory) noexcept { countedFree(memory); }
+void operator delete[] (void *memory) noexcept { countedFree(memory); }
+void operator delete (void *memory, size_t) noexcept { countedFree(memory); }
+void operator delete[] (void *memory, size_t) noexcept { countedFree(memory); }
+void operator delete (void *memory, const nothrow_t &) noexcept { countedFree(memory); }
+void operator delete[] (void *memory, const nothrow_t &) noexcept { countedFree(memory); }
+
+#ifdef __cpp_aligned_new
+void* operator new (size_t size, align_val_t alignment) {
+	void *memory = countedAllocate(size, alignment);
+	if (!memory) {
+		throw bad_alloc();
+	}
+	return memory;
+}
+
+void* operator new[] (size_t size, align_val_t alignment) {
+	void *memory = countedAllocate(size, alignment);
+	if (!memory) {
+		throw bad_alloc();
+	}
+	return memory;
+}
+
+void* operator new (size_t size, align_val_t alignment, const nothrow_t &) noexcept { return countedAllocate(size, alignment); }
+void* operator new[] (size_t size, align_val_t alignment, const nothrow_t &) noexcept { return countedAllocate(size, alignment); }
+
+void operator delete (void *memory, align_val_t alignment) noexcept { countedFree(memory, alignment); }
+void operator delete[] (void *memory, align_val_t alignment) noexcept { countedFree(memory, alignment); }
+void operator delete (void *memory, size_t, align_val_t alignment) noexcept { countedFree(memory, alignment); }
+void operator delete[] (void *memory, size_t, align_val_t alignment) noexcept { countedFree(memory, alignment); }
+void operator delete (void *memory, align_val_t alignment, const nothrow_t &) noexcept { countedFree(memory, alignment); }
+void operator delete[] (void *memory, align_val_t alignment, const nothrow_t &) noexcept { countedFree(memory, alignment); }
+#endif
+
 //used to in obligitary 'throw' construction when no exception is expected
 //(in invalid operations tests, for example)
 class ExceptionEmulator : public exception { };
@@ -111,6 +232,28 @@ bool areEqual (const V1 &a, const V2 &b) {
 	return true;
 }
 
+//Single-pass iterator over 'source' repeated cyclically, ends at position 'index'
+template <typename T>
+class CyclingInputIterator {
+private:
+	const vector<T> *source;
+	size_t index;
+public:
+	typedef input_iterator_tag iterator_category;
+	typedef T value_type;
+	typedef ptrdiff_t difference_type;
+	typedef const T* pointer;
+	typedef const T& reference;
+
+	CyclingInputIterator (const vector<T> *source, size_t index) : source(source), index(index) { }
+
+	const T& operator* () const { return (*source)[index % source->size()]; }
+	CyclingInputIterator& operator++ () { ++index; return *this; }
+
+	bool operator== (const CyclingInputIterator &another) const { return index == another.index; }
+	bool operator!= (const CyclingInputIterator &another) const { return index != another.index; }
+};
+
 ostream& operator<< (ostream &s, const IntIncapsulator &obj) {
 	s << obj.getValue();
 	return s;
@@ -309,8 +452,11 @@ void testMoveConstructor () {
 
 	fillVector(sysVector, random(0, 20));
 	fillVector(myVector, sysVector);
+	typename Vector<T>::iterator first = myVector.begin();
 
+	int containersBefore = watcher.getContainersHostCreated();
 	Vector<T> v_move(move(myVector));
+	int containersAfter = watcher.getContainersHostCreated();
 
 	if (!areEqual(sysVector, v_move) || !myVector.empty()) {
 		cout << "error: bad move constructor" << endl;
@@ -319,6 +465,31 @@ void testMoveConstructor () {
 		cout << "move vector: " << v_move << endl;
 		failTest();
 	}
+
+	//the move allocates nothing, the moved-from vector gets iterator containers when it needs them
+	if (containersAfter != containersBefore || (!sysVector.empty() && first != v_move.begin())) {
+		cout << "error: move constructor allocated iterator containers or lost the iterators" << endl;
+		failTest();
+	}
+
+	myVector = move(v_move);
+	if (!areEqual(sysVector, myVector) || myVector.begin() + myVector.size() != myVector.end()) {
+		cout << "error: moved-from vector is not reusable" << endl;
+		failTest();
+	}
+
+	//a const vector made without iterator containers gets them on begin(); comparing makes none
+	Vector<int> source;
+	source.push_back(1);
+	const Vector<int> constVector (move(source));
+	Vector<int> sameValues;
+	sameValues.push_back(1);
+	int containersBeforeCompare = watcher.getContainersHostCreated();
+	bool same = constVector == sameValues;
+	if (!same || watcher.getContainersHostCreated() != containersBeforeCompare || *constVector.begin() != 1) {
+		cout << "error: bad iterators or comparison of a const moved-to vector" << endl;
+		failTest();
+	}
 }
 
 template <typename T>
@@ -349,6 +520,80 @@ void testIteratorConstructor () {
 		cout << "copy vector: " << v_copy2 << endl;
 		failTest();
 	}
+
+	//with single-pass iterators, spanning several staging chunks
+	fillVector(sysVector, random(1, 20));
+	size_t count = random<size_t>(0, 3 * INPUT_STAGING_CHUNK_BYTES / sizeof(T));
+
+	Vector<T> v_copy3 (CyclingInputIterator<T>(&sysVector, 0), CyclingInputIterator<T>(&sysVector, count));
+	bool equal = v_copy3.size() == count && v_copy3.capacity() == count;
+	for (size_t i = 0; equal && i < count; ++i) {
+		equal = v_copy3[i] == sysVector[i % sysVector.size()];
+	}
+	if (!equal) {
+		cout << "error with input iterators: bad iterator constructor" << endl;
+		cout << "source: " << sysVector << ", count: " << count << endl;
+		cout << "size: " << v_copy3.size() << ", capacity: " << v_copy3.capacity() << endl;
+		failTest();
+	}
+}
+
+template <typename T>
+void testFillConstructor () {
+	cout << endl << ">>>" << "testFillConstructor()" << endl;
+
+	vector<T> values;
+	fillVector(values, 2);
+	size_t count = random(0, 50);
+
+	Vector<T> myVector(count, values[0]);
+	vector<T> sysVector(count, values[0]);
+
+	if (!areEqual(sysVector, myVector)) {
+		cout << "error: bad fill constructor" << endl;
+		cout << "my vector: " << myVector << endl;
+		cout << "sys vector: " << sysVector << endl;
+		failTest();
+	}
+
+	count = random(0, 50);
+	myVector.assign(count, values[1], 4);
+	sysVector.assign(count, values[1]);
+	if (!areEqual(sysVector, myVector)) {
+		cout << "error: bad assign()" << endl;
+		cout << "my vector: " << myVector << endl;
+		cout << "sys vector: " << sysVector << endl;
+		failTest();
+	}
+
+	if (!myVector.empty()) { //the value is one of the replaced elements
+		myVector.assign(count + 1, myVector[0]);
+		sysVector.assign(count + 1, sysVector[0]);
+		if (!areEqual(sysVector, myVector)) {
+			cout << "error: bad assign() of own element" << endl;
+			failTest();
+		}
+	}
+
+	//integers select the fill constructor, not the iterator one
+	Vector<int> ints(5, 3);
+	if (ints.size() != 5 || ints[4] != 3) {
+		cout << "error: Vector<int>(5, 3) is not a fill" << endl;
+		failTest();
+	}
+
+	//parallel first touch: every part is written by its own thread
+	const size_t bigCount = vector_detail::PARALLEL_FILL_THRESHOLD / sizeof(long long) + 3;
+	Vector<long long> big(bigCount, 0x0102030405060708LL, 3);
+	if (big.size() != bigCount || big[0] != 0x0102030405060708LL || big[bigCount / 2] != 0x0102030405060708LL || big[bigCount - 1] != 0x0102030405060708LL) {
+		cout << "error: bad parallel fill" << endl;
+		failTest();
+	}
+	big.assign(bigCount, -1, 3);
+	if (big[0] != -1 || big[bigCount - 1] != -1) {
+		cout << "error: bad parallel memset fill" << endl;
+		failTest();
+	}
 }
 
 template <typename T>
@@ -464,15 +709,38 @@ void testReserveAndShrinkToFit () {
 		failTest();
 	}
 
+	//partial shrink keeps some spare capacity
+	size_t target = myVector.size() + (myVector.capacity() - myVector.size()) / 2;
+	myVector.shrink_to(target);
+
+	if (!areEqual(sysVector, myVector) || myVector.capacity() != target) {
+		cout << "error: bad shrink_to()" << endl;
+		cout << "sys. vector: " << sysVector << endl;
+		cout << "src. vector: " << myVector << endl;
+		cout << "target capacity: " << target << ", capacity: " << myVector.capacity() << endl;
+		failTest();
+	}
+
 	myVector.shrink_to_fit();
 
 	//checking for consistency after shrink_to_fit
-	if (!areEqual(sysVector, myVector)) {
+	if (!areEqual(sysVector, myVector) || myVector.capacity() != myVector.size()) {
 		cout << "error: bad shrink_to_fit()" << endl;
 		cout << "sys. vector: " << sysVector << endl;
 		cout << "src. vector: " << myVector << endl;
 		failTest();
 	}
+
+	//shrinking below size() is limited by size()
+	myVector.reserve(myVector.size() * 2 + 1);
+	myVector.shrink_to(0);
+
+	if (!areEqual(sysVector, myVector) || myVector.capacity() != myVector.size()) {
+		cout << "error: bad shrink_to(0)" << endl;
+		cout << "sys. vector: " << sysVector << endl;
+		cout << "src. vector: " << myVector << endl;
+		failTest();
+	}
 }
 
 template <typename T>
@@ -548,262 +816,1600 @@ void testPopBack () {
 }
 
 template <typename T>
-void testClear () {
-	cout << endl << ">>>" << "testClear()" << endl;
+void testTruncate () {
+	cout << endl << ">>>" << "testTruncate()" << endl;
 
 	Vector<T> myVector;
 	vector<T> sysVector;
 
-	fillVector(sysVector, random(0, 20));
+	fillVector(sysVector, random(0, 40));
 	fillVector(myVector, sysVector);
+	size_t capacity = myVector.capacity();
 
-	myVector.clear();
+	typename Vector<T>::iterator first = myVector.begin();
+	size_t newSize = random<size_t>(0, sysVector.size());
+	myVector.truncate(newSize);
+	myVector.truncate(newSize + 1); //does not grow
+	sysVector.erase(sysVector.begin() + newSize, sysVector.end());
 
-	if (!myVector.empty()) {
-		cout << "bad clear()" << endl;
-		cout << "prev. data: " << sysVector;
-		cout << "having: " << myVector;
+	if (!areEqual(sysVector, myVector) || myVector.capacity() != capacity) {
+		cout << "error: bad truncate()" << endl;
+		cout << "my vector: " << myVector << endl;
+		cout << "sys vector: " << sysVector << endl;
+		failTest();
+	}
+	if (newSize > 0 && !(*first == sysVector[0])) {
+		cout << "error: truncate() invalidated iterators" << endl;
 		failTest();
 	}
-}
 
-#pragma endregion
+	size_t count = random<size_t>(0, sysVector.size());
+	myVector.pop_back_n(count);
+	sysVector.erase(sysVector.end() - count, sysVector.end());
+	if (!areEqual(sysVector, myVector)) {
+		cout << "error: bad pop_back_n()" << endl;
+		cout << "my vector: " << myVector << endl;
+		cout << "sys vector: " << sysVector << endl;
+		failTest();
+	}
 
-#pragma region test Iterators
+	testException<InvalidOperationException>([&](){ myVector.pop_back_n(myVector.size() + 1); }, "myVector.pop_back_n(size() + 1)");
+}
 
 template <typename T>
-void testRangedFor () {
-	cout << endl << ">>>" << "testRangedFor()" << endl;
+void testTryOperations () {
+	cout << endl << ">>>" << "testTryOperations()" << endl;
 
 	Vector<T> myVector;
 	vector<T> sysVector;
 
 	fillVector(sysVector, random(0, 20));
-	fillVector(myVector, sysVector);
-
-	typename vector<T>::iterator sysIt = sysVector.begin();
-	typename vector<T>::iterator sysEnd = sysVector.end();
-
-	for (T& element : myVector) {
-		if (!(element == *sysIt)) {
-			cout << "error: bad ranged for" << endl;
-			cout << "my vector: " << myVector << endl;
-			cout << "sys vector: " << sysVector << endl;
+	for (size_t i = 0; i < sysVector.size(); ++i) {
+		T copy(sysVector[i]);
+		if (!myVector.try_push_back(std::move(copy))) {
+			cout << "error: try_push_back() failed" << endl;
 			failTest();
 		}
-		++sysIt;
+	}
+	if (!areEqual(sysVector, myVector)) {
+		cout << "error: bad try_push_back()" << endl;
+		cout << "my vector: " << myVector << endl;
+		cout << "sys vector: " << sysVector << endl;
+		failTest();
 	}
 
-
-	Vector<typename Vector<T>::iterator> iterVector;
-	for (size_t i = 0, sz = myVector.size(); i < sz; ++i) {
-		iterVector.push_back(myVector.begin() + i);
+	VectorExpected<void> reserved = myVector.try_reserve(myVector.max_size() + 1);
+	if (reserved || reserved.error() != VectorError::capacity_too_large || !myVector.try_reserve(myVector.size() * 2 + 1)) {
+		cout << "error: bad try_reserve()" << endl;
+		failTest();
 	}
 
-	for (size_t i = 0, sz = myVector.size(); i < sz; ++i) {
-		if (!(*(iterVector[i]) == myVector[i])) {
-			cout << "error: bad iterator created" << endl;
-			cout << "my vector: " << myVector << endl;
-			cout << "position: " << i << ", myValue = " << myVector[i] << ", iterValue = " << *(iterVector[i]) << endl;
-			failTest();
-		}
+	const Vector<T> &constVector = myVector;
+	VectorExpected<const T> missing = constVector.at_checked(myVector.size());
+	if (missing.has_value() || missing.error() != VectorError::index_out_of_range) {
+		cout << "error: at_checked() past the end" << endl;
+		failTest();
+	}
+	if (!sysVector.empty() && !(*myVector.at_checked(0) == sysVector[0])) {
+		cout << "error: bad at_checked()" << endl;
+		failTest();
 	}
+	testException<InvalidOperationException>([&](){ missing.value(); }, "missing.value()");
 }
 
 template <typename T>
-void testIteratorValidity () {
-	cout << endl << ">>>" << "testIteratorValidity()" << endl;
+void testClear () {
+	cout << endl << ">>>" << "testClear()" << endl;
 
-	Vector<T> v;
+	Vector<T> myVector;
+	vector<T> sysVector;
 
-	v.reserve(25);
-	fillVector(v, random(5, 20));
+	fillVector(sysVector, random(0, 20));
+	fillVector(myVector, sysVector);
 
-    typename Vector<T>::iterator it = v.begin();
+	myVector.clear();
 
-	auto checkValidity = [&](const string method_name) {
-		try { *it; }
-		catch (exception &ex) {
-			cout << "Error! Iterator became invalid after calling method \"" << method_name << "\"" << endl;
-			cout << "It was begin() iterator on vector: " << v << endl;
-			cout << "Exception: " << ex.what() << endl;
-			failTest();
-		}
-	};
+	if (!myVector.empty()) {
+		cout << "bad clear()" << endl;
+		cout << "prev. data: " << sysVector;
+		cout << "having: " << myVector;
+		failTest();
+	}
 
-	Vector<T> v2;
-	fillVector(v2, random(5, 20));
+	fillVector(myVector, sysVector);
+	size_t capacity = myVector.capacity();
+	myVector.clear(true);
 
-	v.empty();
-	checkValidity ("empty");
-	v.size();
-	checkValidity ("size");
-	v.capacity();
-	checkValidity ("capacity");
-	v[0];
-	checkValidity ("[] const");
-	v.pop_back();
-	checkValidity ("pop_back");
-	v.push_back (v2[0]);
-	checkValidity ("push_back");
+	if (!myVector.empty() || myVector.capacity() != capacity) {
+		cout << "bad clear(true)" << endl;
+		cout << "having: " << myVector;
+		failTest();
+	}
 }
 
 template <typename T>
-void testIteratorCasts () {
-	cout << endl << ">>>" << "testIteratorCasts()" << endl;
-
-	Vector<T> v;
-	
-	v.cbegin() == v.begin();
-	v.begin() == v.cbegin();
-	v.rbegin() == v.crbegin();
-	v.crbegin() == v.rbegin();
-	v.cbegin() >= v.begin();
-	v.begin() > v.cbegin();
-
-	v.begin() - v.cbegin();
-	v.cbegin() - v.begin();
-
-	typename Vector<T>::const_iterator it = v.begin();
-	typename Vector<T>::iterator it2 = v.begin();
-
-	it = v.begin();
-	it = v.cbegin();
-	it = it2;
-
-	(typename Vector<T>::const_iterator)(v.begin());
-	(typename Vector<T>::const_reverse_iterator)(v.rbegin());
-}
+void testStorageOptions () {
+	cout << endl << ">>>" << "testStorageOptions()" << endl;
 
-template <typename T>
-void testIteratorTraits () {
-	cout << endl << ">>>" << "testIteratorTraits()" << endl;
+	Vector<T> myVector (StorageOptions::cacheAligned());
+	vector<T> sysVector;
 
-	testException<ExceptionEmulator> ([&](){
-		Vector<T> v;
-		fillVector(v, random(1, 5));
-		typename std::iterator_traits<typename Vector<T>::iterator>::value_type value = std::move(*v.begin());
-		throw ExceptionEmulator();
-	}, "std::iterator_traits<typename Vector<T>::iterator>::value_type value = *iter");
+	fillVector(sysVector, random(1, 20));
+	fillVector(myVector, sysVector);
 
-	if (typeid(typename std::iterator_traits<typename Vector<T>::iterator>::value_type) != typeid(T)) {
-		cout << "cannot determine iterator value type properly" << endl;
-		cout << "iterator_traits::value_type = " << typeid(typename std::iterator_traits<typename Vector<T>::iterator>::value_type).name() << endl;
-		cout << "T = " << typeid(T).name() << endl;
-		failTest();
-	}
-	if (typeid(typename std::iterator_traits<typename Vector<T>::iterator>::iterator_category) != typeid(random_access_iterator_tag)) {
-		cout << "iterator_traits::iterator_category = " << typeid(typename std::iterator_traits<typename Vector<T>::iterator>::iterator_category).name() << endl;
+	if (!areEqual(sysVector, myVector) || reinterpret_cast<uintptr_t>(&myVector[0]) % CACHE_LINE_SIZE != 0) {
+		cout << "error: bad cache aligned storage" << endl;
+		cout << "sys. vector: " << sysVector << endl;
+		cout << "src. vector: " << myVector << endl;
 		failTest();
 	}
-	if (typeid(typename std::iterator_traits<typename Vector<T>::const_iterator>::value_type) != typeid(T)) {
-		cout << "cannot determine const iterator value type properly" << endl;
-		cout << "iterator_traits::value_type = " << typeid(typename std::iterator_traits<typename Vector<T>::const_iterator>::value_type).name() << endl;
-		cout << "T = " << typeid(T).name() << endl;
+
+	myVector.set_storage_options(StorageOptions::pageAligned());
+
+	if (!areEqual(sysVector, myVector) || reinterpret_cast<uintptr_t>(&myVector[0]) % SMALL_PAGE_SIZE != 0) {
+		cout << "error: bad set_storage_options()" << endl;
+		cout << "sys. vector: " << sysVector << endl;
+		cout << "src. vector: " << myVector << endl;
 		failTest();
 	}
-	if (typeid(typename std::iterator_traits<typename Vector<T>::const_iterator>::iterator_category) != typeid(random_access_iterator_tag)) {
-		cout << "iterator_traits::iterator_category = " << typeid(typename std::iterator_traits<typename Vector<T>::const_iterator>::iterator_category).name() << endl;
+
+	//huge page advice, mlock and prefault for any buffer
+	myVector.set_storage_options(StorageOptions::latencyCritical(1));
+	myVector.clear();
+	fillVector(myVector, sysVector);
+
+	if (!areEqual(sysVector, myVector) || reinterpret_cast<uintptr_t>(&myVector[0]) % HUGE_PAGE_SIZE != 0) {
+		cout << "error: bad latency critical storage" << endl;
+		cout << "sys. vector: " << sysVector << endl;
+		cout << "src. vector: " << myVector << endl;
 		failTest();
 	}
 }
 
 template <typename T>
-void testReverseIterators () {
-	cout << endl << ">>>" << "testReverseIterators()" << endl;
+void testMappedStorage () {
+	cout << endl << ">>>" << "testMappedStorage()" << endl;
 
-	Vector<T> v;
+	//every buffer of at least one page is an anonymous mapping (on Linux)
+	StorageOptions options;
+	options.mmapThreshold = SMALL_PAGE_SIZE;
 
-	fillVector (v, random(5, 20));
+	Vector<T> myVector (options);
+	vector<T> sysVector;
 
-	typename Vector<T>::reverse_iterator revIter = v.rbegin(); //end
-	typename Vector<T>::iterator iter = v.end() - 1;
+	fillVector(sysVector, random<size_t>(SMALL_PAGE_SIZE / sizeof(T), 4 * SMALL_PAGE_SIZE / sizeof(T)));
+	fillVector(myVector, sysVector);
 
-	typename Vector<T>::iterator begin = v.begin();
+	if (!areEqual(sysVector, myVector)) {
+		cout << "error: bad growth of mapped storage" << endl;
+		cout << "sys. vector: " << sysVector << endl;
+		cout << "src. vector: " << myVector << endl;
+		failTest();
+	}
+
+	myVector.reserve(myVector.capacity() * 3);
+	myVector.shrink_to_fit();
+
+	if (!areEqual(sysVector, myVector)) {
+		cout << "error: bad reserve/shrink of mapped storage" << endl;
+		cout << "sys. vector: " << sysVector << endl;
+		cout << "src. vector: " << myVector << endl;
+		failTest();
+	}
+}
+
+template <typename T>
+void testRecycledStorage () {
+	cout << endl << ">>>" << "testRecycledStorage()" << endl;
+
+	BufferRecycler &recycler = BufferRecycler::local();
+	vector<T> sysVector;
+	fillVector(sysVector, random(1, 100));
+
+	{
+		Vector<T> scratch (StorageOptions::recycled());
+		fillVector(scratch, sysVector);
+	}
+	size_t retained = recycler.bytesRetained();
+	size_t hits = recycler.hits();
+
+	//the same size classes: the buffers of the second vector come from the cache
+	Vector<T> myVector (StorageOptions::recycled());
+	fillVector(myVector, sysVector);
+
+	if (!areEqual(sysVector, myVector)) {
+		cout << "error: bad contents of recycled storage" << endl;
+		cout << "sys. vector: " << sysVector << endl;
+		cout << "src. vector: " << myVector << endl;
+		failTest();
+	}
+	if (retained == 0 || recycler.hits() == hits || recycler.hitRate() <= 0) {
+		cout << "error: buffers were not recycled" << endl;
+		failTest();
+	}
+
+	recycler.setLimit(0);
+	if (recycler.bytesRetained() != 0) {
+		cout << "error: recycler limit is not applied" << endl;
+		failTest();
+	}
+	recycler.setLimit(RECYCLER_DEFAULT_LIMIT);
+
+	//made before the thread's recycler, so destroyed after it at thread exit: the buffer goes to free()
+	thread exiting([]() {
+		static thread_local Vector<T> survivor (StorageOptions::recycled());
+		fillVector(survivor, 3);
+	});
+	exiting.join();
+}
+
+template <typename T>
+void testSizingHints () {
+	cout << endl << ">>>" << "testSizingHints()" << endl;
+
+	SizingHint hint;
+	vector<T> sysVector;
+
+	fillVector(sysVector, random(1, 40));
+
+	for (int round = 0; round < 10; ++round) {
+		Vector<T> myVector (hint);
+
+		if (round > 0 && myVector.capacity() != sysVector.size()) {
+			cout << "error: bad predicted capacity" << endl;
+			cout << "expected: " << sysVector.size() << ", capacity: " << myVector.capacity() << endl;
+			failTest();
+		}
+
+		//filled without clear(), which would drop the predicted reservation
+		Vector<T> values;
+		fillVector(values, sysVector);
+		size_t capacityBefore = myVector.capacity();
+		const T *dataBefore = myVector.data();
+		for (size_t i = 0; i < values.size(); ++i) {
+			myVector.push_back(move(values[i]));
+		}
+
+		if (round > 0 && (myVector.capacity() != capacityBefore || myVector.data() != dataBefore)) {
+			cout << "error: filling to the predicted size reallocated" << endl;
+			cout << "capacity before: " << capacityBefore << ", after: " << myVector.capacity() << endl;
+			failTest();
+		}
+	}
+
+	if (hint.misses() != 1 || hint.hits() != 9) {
+		cout << "error: bad sizing hint counters" << endl;
+		cout << "hits: " << hint.hits() << ", misses: " << hint.misses() << endl;
+		failTest();
+	}
+
+	//built in a hinted vector, then move-assigned to the result: the hint learns the size of the result
+	SizingHint movedHint;
+	{
+		Vector<T> result;
+		for (int round = 0; round < 3; ++round) {
+			Vector<T> built (movedHint);
+			fillVector(built, sysVector);
+			result = move(built);
+		}
+	}
+	if (movedHint.predict() != sysVector.size() || movedHint.hits() + movedHint.misses() != 3) {
+		cout << "error: sizing hint did not follow move assignment" << endl;
+		cout << "predicted: " << movedHint.predict() << ", hits: " << movedHint.hits() << ", misses: " << movedHint.misses() << endl;
+		failTest();
+	}
+
+	//an empty vector with no prediction is not a sample
+	SizingHint emptyHint;
+	{
+		Vector<T> unused (emptyHint);
+	}
+	if (emptyHint.hits() != 0 || emptyHint.misses() != 0 || emptyHint.predict() != 0) {
+		cout << "error: empty unpredicted vector was recorded" << endl;
+		cout << "hits: " << emptyHint.hits() << ", misses: " << emptyHint.misses() << endl;
+		failTest();
+	}
+
+	SizingHint *hints[2];
+	for (int i = 0; i < 2; ++i) {
+		hints[i] = &VECTOR_CALL_SITE_HINT();
+	}
+	if (hints[0] != hints[1] || hints[0] != &SizingHintRegistry::instance().hint(string(__FILE__) + ":" + to_string(__LINE__ - 2))) {
+		cout << "error: bad call site hint" << endl;
+		failTest();
+	}
+}
+
+template <typename T>
+void testViews () {
+	cout << endl << ">>>" << "testViews()" << endl;
+
+	Vector<T> myVector;
+	vector<T> sysVector;
+
+	fillVector(sysVector, random(2, 20));
+	fillVector(myVector, sysVector);
+
+	VectorView<T> all = myVector.view();
+	ConstVectorView<T> constAll = all;
+
+	if (!areEqual(sysVector, all) || !areEqual(sysVector, constAll)) {
+		cout << "error: bad view()" << endl;
+		cout << "sys. vector: " << sysVector << endl;
+		cout << "src. vector: " << myVector << endl;
+		failTest();
+	}
+
+	//every second element starting from the second one
+	VectorView<T> odd = all.subview(1, sysVector.size() / 2, 2);
+	size_t index = 1;
+	for (T& element : odd) {
+		if (!(element == sysVector[index])) {
+			cout << "error: bad strided subview" << endl;
+			cout << "sys. vector: " << sysVector << endl;
+			cout << "position: " << index << endl;
+			failTest();
+		}
+		index += 2;
+	}
+	if (odd.size() != sysVector.size() / 2) {
+		cout << "error: bad subview size" << endl;
+		failTest();
+	}
+
+	testException<IndexOutOfRangeException>([&](){ all[all.size()]; }, "all[all.size()]");
+	testException<IndexOutOfRangeException>([&](){ all.subview(0, all.size() + 1); }, "all.subview(0, size + 1)");
+	testException<IndexOutOfRangeException>([&](){ myVector.view(1, myVector.size()); }, "v.view(1, size)");
+
+	myVector.reserve(myVector.capacity() * 2 + 1);
+	testException<InvalidViewException>([&](){ all[0]; }, "all[0] after reserve");
+	testException<InvalidViewException>([&](){ odd.begin(); }, "odd.begin() after reserve");
+	testException<InvalidViewException>([&](){ constAll.data(); }, "constAll.data() after reserve");
+}
+
+#pragma endregion
+
+#pragma region test Iterators
+
+template <typename T>
+void testRangedFor () {
+	cout << endl << ">>>" << "testRangedFor()" << endl;
+
+	Vector<T> myVector;
+	vector<T> sysVector;
+
+	fillVector(sysVector, random(0, 20));
+	fillVector(myVector, sysVector);
+
+	typename vector<T>::iterator sysIt = sysVector.begin();
+	typename vector<T>::iterator sysEnd = sysVector.end();
+
+	for (T& element : myVector) {
+		if (!(element == *sysIt)) {
+			cout << "error: bad ranged for" << endl;
+			cout << "my vector: " << myVector << endl;
+			cout << "sys vector: " << sysVector << endl;
+			failTest();
+		}
+		++sysIt;
+	}
+
+
+	Vector<typename Vector<T>::iterator> iterVector;
+	for (size_t i = 0, sz = myVector.size(); i < sz; ++i) {
+		iterVector.push_back(myVector.begin() + i);
+	}
+
+	for (size_t i = 0, sz = myVector.size(); i < sz; ++i) {
+		if (!(*(iterVector[i]) == myVector[i])) {
+			cout << "error: bad iterator created" << endl;
+			cout << "my vector: " << myVector << endl;
+			cout << "position: " << i << ", myValue = " << myVector[i] << ", iterValue = " << *(iterVector[i]) << endl;
+			failTest();
+		}
+	}
+}
+
+template <typename T>
+void testChunks () {
+	cout << endl << ">>>" << "testChunks()" << endl;
+
+	Vector<T> myVector;
+	vector<T> sysVector;
+
+	fillVector(sysVector, random(0, 100));
+	fillVector(myVector, sysVector);
+
+	size_t chunk = random(1, 10);
+	size_t index = 0;
+	bool match = true;
+	myVector.for_each_chunk([&](T *data, size_t count) {
+		match = match && count > 0 && count <= chunk;
+		for (size_t i = 0; i < count; ++i, ++index) {
+			match = match && data[i] == sysVector[index];
+		}
+	}, chunk);
+
+	if (!match || index != sysVector.size()) {
+		cout << "error: bad for_each_chunk()" << endl;
+		cout << "my vector: " << myVector << endl;
+		cout << "sys vector: " << sysVector << endl;
+		failTest();
+	}
+
+	const Vector<T> &constVector = myVector;
+	index = 0;
+	for (VectorChunk<const T> span : constVector.chunks(chunk)) {
+		for (const T &element : span) {
+			if (!(element == sysVector[index++])) {
+				cout << "error: bad chunks()" << endl;
+				cout << "my vector: " << myVector << endl;
+				cout << "sys vector: " << sysVector << endl;
+				failTest();
+			}
+		}
+	}
+	if (index != sysVector.size()) {
+		cout << "error: chunks() skipped elements" << endl;
+		failTest();
+	}
+
+	if (myVector.size() > 1) {
+		testException<InvalidOperationException>([&](){
+			myVector.for_each_chunk([&](T*, size_t) { myVector.pop_back(); }, 1);
+		}, "pop_back() in for_each_chunk");
+
+		//refilled to the same size in the same buffer: still a modification
+		auto refill = [&]() {
+			T last(move(myVector[myVector.size() - 1]));
+			myVector.pop_back();
+			myVector.push_back(move(last));
+		};
+		testException<InvalidOperationException>([&](){
+			myVector.for_each_chunk([&](T*, size_t) { refill(); }, 1);
+		}, "pop_back() + push_back() in for_each_chunk");
+		testException<InvalidOperationException>([&](){
+			for (VectorChunk<T> chunk : myVector.chunks(1)) {
+				(void) chunk;
+				refill();
+			}
+		}, "pop_back() + push_back() in chunks()");
+	}
+}
+
+template <typename T>
+void testCheckedRange () {
+	cout << endl << ">>>" << "testCheckedRange()" << endl;
+
+	Vector<T> myVector;
+	vector<T> sysVector;
+
+	fillVector(sysVector, random(0, 20));
+	fillVector(myVector, sysVector);
+
+	size_t index = 0;
+	for (T &element : myVector.checked()) {
+		if (!(element == sysVector[index++])) {
+			cout << "error: bad checked()" << endl;
+			cout << "my vector: " << myVector << endl;
+			cout << "sys vector: " << sysVector << endl;
+			failTest();
+		}
+	}
+	if (index != sysVector.size()) {
+		cout << "error: checked() skipped elements" << endl;
+		failTest();
+	}
+
+	const Vector<T> &constVector = myVector;
+	size_t offset = random(0, static_cast<int>(sysVector.size()));
+	index = offset;
+	for (const T &element : constVector.checked(offset, sysVector.size() - offset)) {
+		if (!(element == sysVector[index++])) {
+			cout << "error: bad checked(offset, count)" << endl;
+			failTest();
+		}
+	}
+	testException<IndexOutOfRangeException>([&](){ constVector.checked(offset, sysVector.size() - offset + 1); }, "checked() past the end");
+
+	//the loop stops at the first step after the buffer moved or shrank
+	if (!myVector.empty()) {
+		testException<InvalidOperationException>([&](){
+			for (T &element : myVector.checked()) {
+				(void)element;
+				myVector.reserve(myVector.capacity() * 2 + 1);
+			}
+		}, "reserve() in checked range-for");
+		testException<InvalidOperationException>([&](){
+			for (T &element : myVector.checked()) {
+				(void)element;
+				myVector.pop_back();
+			}
+		}, "pop_back() in checked range-for");
+	}
+}
+
+template <typename T>
+void testIteratorValidity () {
+	cout << endl << ">>>" << "testIteratorValidity()" << endl;
+
+	Vector<T> v;
+
+	v.reserve(25);
+	fillVector(v, random(5, 20));
+
+    typename Vector<T>::iterator it = v.begin();
+
+	auto checkValidity = [&](const string method_name) {
+		try { *it; }
+		catch (exception &ex) {
+			cout << "Error! Iterator became invalid after calling method \"" << method_name << "\"" << endl;
+			cout << "It was begin() iterator on vector: " << v << endl;
+			cout << "Exception: " << ex.what() << endl;
+			failTest();
+		}
+	};
+
+	Vector<T> v2;
+	fillVector(v2, random(5, 20));
+
+	v.empty();
+	checkValidity ("empty");
+	v.size();
+	checkValidity ("size");
+	v.capacity();
+	checkValidity ("capacity");
+	v[0];
+	checkValidity ("[] const");
+	v.pop_back();
+	checkValidity ("pop_back");
+	v.push_back (v2[0]);
+	checkValidity ("push_back");
+}
+
+template <typename T>
+void testIteratorCasts () {
+	cout << endl << ">>>" << "testIteratorCasts()" << endl;
+
+	Vector<T> v;
+	
+	v.cbegin() == v.begin();
+	v.begin() == v.cbegin();
+	v.rbegin() == v.crbegin();
+	v.crbegin() == v.rbegin();
+	v.cbegin() >= v.begin();
+	v.begin() > v.cbegin();
+
+	v.begin() - v.cbegin();
+	v.cbegin() - v.begin();
+
+	typename Vector<T>::const_iterator it = v.begin();
+	typename Vector<T>::iterator it2 = v.begin();
+
+	it = v.begin();
+	it = v.cbegin();
+	it = it2;
+
+	(typename Vector<T>::const_iterator)(v.begin());
+	(typename Vector<T>::const_reverse_iterator)(v.rbegin());
+}
+
+template <typename T>
+void testIteratorTraits () {
+	cout << endl << ">>>" << "testIteratorTraits()" << endl;
+
+	testException<ExceptionEmulator> ([&](){
+		Vector<T> v;
+		fillVector(v, random(1, 5));
+		typename std::iterator_traits<typename Vector<T>::iterator>::value_type value = std::move(*v.begin());
+		throw ExceptionEmulator();
+	}, "std::iterator_traits<typename Vector<T>::iterator>::value_type value = *iter");
+
+	if (typeid(typename std::iterator_traits<typename Vector<T>::iterator>::value_type) != typeid(T)) {
+		cout << "cannot determine iterator value type properly" << endl;
+		cout << "iterator_traits::value_type = " << typeid(typename std::iterator_traits<typename Vector<T>::iterator>::value_type).name() << endl;
+		cout << "T = " << typeid(T).name() << endl;
+		failTest();
+	}
+	if (typeid(typename std::iterator_traits<typename Vector<T>::iterator>::iterator_category) != typeid(random_access_iterator_tag)) {
+		cout << "iterator_traits::iterator_category = " << typeid(typename std::iterator_traits<typename Vector<T>::iterator>::iterator_category).name() << endl;
+		failTest();
+	}
+	if (typeid(typename std::iterator_traits<typename Vector<T>::const_iterator>::value_type) != typeid(T)) {
+		cout << "cannot determine const iterator value type properly" << endl;
+		cout << "iterator_traits::value_type = " << typeid(typename std::iterator_traits<typename Vector<T>::const_iterator>::value_type).name() << endl;
+		cout << "T = " << typeid(T).name() << endl;
+		failTest();
+	}
+	if (typeid(typename std::iterator_traits<typename Vector<T>::const_iterator>::iterator_category) != typeid(random_access_iterator_tag)) {
+		cout << "iterator_traits::iterator_category = " << typeid(typename std::iterator_traits<typename Vector<T>::const_iterator>::iterator_category).name() << endl;
+		failTest();
+	}
+}
+
+template <typename T>
+void testContiguousIterators () {
+	cout << endl << ">>>" << "testContiguousIterators()" << endl;
+
+	Vector<T> myVector;
+	vector<T> sysVector;
+
+	fillVector(sysVector, random(1, 20));
+	fillVector(myVector, sysVector);
+
+	const Vector<T> &constVector = myVector;
+	for (size_t i = 0, sz = sysVector.size(); i < sz; ++i) {
+		if (!(myVector.data()[i] == sysVector[i]) || constVector.data() + i != &myVector[i]) {
+			cout << "error: bad data()" << endl;
+			cout << "sys. vector: " << sysVector << endl;
+			cout << "position: " << i << endl;
+			failTest();
+		}
+	}
+
+	#ifdef VECTOR_CXX20
+	static_assert(std::contiguous_iterator<typename Vector<T>::iterator>, "iterator must be contiguous");
+	static_assert(std::contiguous_iterator<typename Vector<T>::const_iterator>, "const_iterator must be contiguous");
+	static_assert(std::ranges::contiguous_range<Vector<T>>, "Vector must be a contiguous range");
+
+	if (std::to_address(myVector.begin()) != myVector.data() || std::to_address(myVector.cend()) != myVector.data() + myVector.size()) {
+		cout << "error: bad std::to_address" << endl;
+		failTest();
+	}
+
+	Vector<int> numbers;
+	fillVector(numbers, random(0, 50));
+	std::ranges::sort(numbers);
+	if (!std::is_sorted(numbers.data(), numbers.data() + numbers.size())) {
+		cout << "error: bad std::ranges::sort: " << numbers << endl;
+		failTest();
+	}
+	#endif
+}
+
+template <typename T>
+void testReverseIterators () {
+	cout << endl << ">>>" << "testReverseIterators()" << endl;
+
+	Vector<T> v;
+
+	fillVector (v, random(5, 20));
+
+	typename Vector<T>::reverse_iterator revIter = v.rbegin(); //end
+	typename Vector<T>::iterator iter = v.end() - 1;
+
+	typename Vector<T>::iterator begin = v.begin();
+
+	while (true) {
+		if (!(*iter == *revIter)) {
+			cout << "Error! Bad reverse_iterator!" << endl;
+			cout << "*revIter = " << *revIter << ", *iter = " << *iter << endl;
+			cout << "vector = " << v << endl;
+			failTest();
+		}
+		if (iter == begin) {
+			break;
+		}
+
+		iter--;
+		revIter++;
+	}
+}
+
+template <typename T>
+void testIteratorUnaryIncrement () {
+	cout << endl << ">>>" << "testIteratorUnaryIncrement()" << endl;
+
+	Vector<T> v1;
+	fillVector (v1, 3);
+
+	Iterator<T> it = v1.begin();
+	T value1 = *(++it);
+
+	if (!(value1 == *(v1.begin() + 1)) || it != v1.begin() + 1) {
+		cout << "Error! bad prefix unary increment operator!" << endl;
+		cout << "value1 = " << value1 << ", *it = " << *it << ", vector = " << v1 << endl;
+		failTest();
+	}
+
+	it = v1.begin();
+	T value0 = *(it++);
+
+	if (!(value0 == *v1.begin()) || it != v1.begin() + 1) {
+		cout << "Error! bad postfix unary increment operator!" << endl;
+		cout << "value0 = " << value0 << ", *it = " << *it << ", vector = " << v1 << endl;
+		failTest();
+	}
+}
+
+template <typename T>
+void testIteratorOperations () {
+	cout << endl << ">>>" << "testIteratorOperations()" << endl;
+
+	vector<T> sys;
+	fillVector (sys, 5);
+	
+	Vector<T> v1;
+	fillVector(v1, random(3, 20));
+	Vector<T> v2;
+	fillVector(v2, random(3, 20));
+
+	testException<DifferentIteratorDomainException>([&](){ v1.begin() - v2.begin(); }, "v1.begin - v2.begin");
+	testException<DifferentIteratorDomainException>([&](){ v1.begin() >= v2.begin(); }, "v1.begin >= v2.begin");
+
+	testException<InvalidIteratorShiftException>([&](){ v1.begin() + 1000; }, "v1.begin + 1000");
+	testException<InvalidIteratorShiftException>([&](){ v1.begin() - 1; }, "v1.begin - 1");
+	testException<InvalidIteratorShiftException>([&](){ v1.end() + 1; }, "v1.end + 1");
+
+	//won't compile
+	//testException<ExceptionEmulator>([&](){ *v1.cbegin() = *v2.begin(); }, "*v1.cbegin = *v2.begin");
+
+	testException<ExceptionEmulator>([&](){ *v1.begin() = *v2.begin(); throw ExceptionEmulator(); }, "*v1.begin = *v2.begin");
+	testException<ExceptionEmulator>([&](){ *v1.begin() = *v2.cbegin(); throw ExceptionEmulator(); }, "*v1.begin = *v2.cbegin");
+	testException<ExceptionEmulator>([&](){ v1.end() - 1; throw ExceptionEmulator(); }, "v1.end() - 1; throw 0");
+	testException<ExceptionEmulator>([&](){ *(v1.begin() + 1); throw ExceptionEmulator(); }, "*(v1.begin + 1); throw 0");
+	testException<ExceptionEmulator>([&](){ Iterator<T> it = v1.begin(); if (*it == *v1.begin()) throw ExceptionEmulator(); else throw "!"; }, "it = v1.begin; *it == *v1.begin?");
+	testException<ExceptionEmulator>([&](){ if (1 + v1.begin() == v1.begin() + 1) throw ExceptionEmulator(); else throw "!"; }, "1 + v1.begin == v1.begin + 1");
+
+	testException<IteratorOutOfRangeException>([&](){ *v1.end();}, "*v1.end");
+
+	typename Vector<T>::iterator it = v1.begin();
+	v1.reserve(100);
+	testException<InvalidIteratorException>([&](){ *it; }, "*it");
+
+	testException<InvalidIteratorException>([&](){ it == v1.begin(); }, "it == v1.begin");
+
+	testException<IndexOutOfRangeException>([&](){ v1[1000]; }, "v1[1000]");
+
+	v1.clear();
+	testException<InvalidOperationException>([&](){ v1.pop_back(); }, "v1.pop_back()");
+}
+
+#pragma endregion
+
+#pragma region test containers
+
+void testFlatSet () {
+	cout << endl << ">>>" << "testFlatSet()" << endl;
+
+	FlatSet<int> mySet;
+	set<int> sysSet;
+
+	//single inserts and erases
+	for (int i = 0, count = random(0, 100); i < count; ++i) {
+		int key = random(-50, 50);
+		if (mySet.insert(key) != sysSet.insert(key).second) {
+			cout << "error: bad FlatSet::insert(" << key << ")" << endl;
+			failTest();
+		}
+	}
+	for (int i = 0, count = random(0, 30); i < count; ++i) {
+		int key = random(-50, 50);
+		if (mySet.erase(key) != (sysSet.erase(key) == 1)) {
+			cout << "error: bad FlatSet::erase(" << key << ")" << endl;
+			failTest();
+		}
+	}
+
+	//batched insert
+	vector<int> batch;
+	fillVector(batch, random(0, 200));
+	mySet.insert(batch.begin(), batch.end());
+	sysSet.insert(batch.begin(), batch.end());
+
+	if (!areEqual(vector<int>(sysSet.begin(), sysSet.end()), mySet.data())) {
+		cout << "error: bad FlatSet contents" << endl;
+		cout << "sys. set: " << vector<int>(sysSet.begin(), sysSet.end()) << endl;
+		cout << "my set: " << mySet.data() << endl;
+		failTest();
+	}
+
+	for (int key = -60; key <= 100010; key += random(1, 1000)) {
+		set<int>::iterator sysIt = sysSet.lower_bound(key);
+		ptrdiff_t expected = distance(sysSet.begin(), sysIt);
+
+		if (mySet.lower_bound(key) - mySet.begin() != expected || mySet.contains(key) != (sysSet.count(key) == 1)) {
+			cout << "error: bad FlatSet::lower_bound(" << key << ")" << endl;
+			cout << "expected position: " << expected << ", got: " << (mySet.lower_bound(key) - mySet.begin()) << endl;
+			failTest();
+		}
+	}
+
+	//a batch that fails to sort leaves the set as it was
+	auto poisonedLess = [](int a, int b) {
+		if (a == -1000 || b == -1000) {
+			throw ExceptionEmulator();
+		}
+		return a < b;
+	};
+	FlatSet<int, decltype(poisonedLess)> guarded (poisonedLess);
+	guarded.insert(batch.begin(), batch.end());
+	vector<int> poisoned (batch);
+	poisoned.push_back(-1000);
+	poisoned.push_back(7);
+	testException<ExceptionEmulator>([&](){ guarded.insert(poisoned.begin(), poisoned.end()); }, "guarded.insert(poisoned batch)");
+	set<int> batchSet (batch.begin(), batch.end());
+	if (!areEqual(vector<int>(batchSet.begin(), batchSet.end()), guarded.data())) {
+		cout << "error: failed FlatSet batch insert changed the set" << endl;
+		failTest();
+	}
+}
+
+void testFlatMap () {
+	cout << endl << ">>>" << "testFlatMap()" << endl;
+
+	FlatMap<int, Vector<int>> myMap;
+	map<int, Vector<int>> sysMap;
+
+	for (int i = 0, count = random(0, 100); i < count; ++i) {
+		int key = random(-50, 50);
+		Vector<int> value;
+		fillVector(value, random(0, 5));
+
+		if (myMap.insert(key, value) != sysMap.insert(make_pair(key, value)).second) {
+			cout << "error: bad FlatMap::insert(" << key << ")" << endl;
+			failTest();
+		}
+	}
+	for (int i = 0, count = random(0, 30); i < count; ++i) {
+		int key = random(-50, 50);
+		if (myMap.erase(key) != (sysMap.erase(key) == 1)) {
+			cout << "error: bad FlatMap::erase(" << key << ")" << endl;
+			failTest();
+		}
+	}
+
+	vector<pair<int, Vector<int>>> batch;
+	for (int i = 0, count = random(0, 100); i < count; ++i) {
+		Vector<int> value;
+		fillVector(value, random(0, 5));
+		batch.push_back(make_pair(random(-100, 100), value));
+	}
+	myMap.insert(batch.begin(), batch.end());
+	sysMap.insert(batch.begin(), batch.end());
+
+	myMap[1000].push_back(1);
+	sysMap[1000].push_back(1);
+
+	if (myMap.size() != sysMap.size()) {
+		cout << "error: bad FlatMap size: " << myMap.size() << ", expected: " << sysMap.size() << endl;
+		failTest();
+	}
+
+	size_t index = 0;
+	for (map<int, Vector<int>>::iterator i = sysMap.begin(); i != sysMap.end(); ++i, ++index) {
+		if (myMap.key_data()[index] != i->first || myMap.value_data()[index] != i->second || myMap.at(i->first) != i->second) {
+			cout << "error: bad FlatMap contents at key " << i->first << endl;
+			failTest();
+		}
+	}
+
+	testException<KeyNotFoundException>([&](){ myMap.at(-1000); }, "myMap.at(-1000)");
+}
+
+void testBitVector () {
+	cout << endl << ">>>" << "testBitVector()" << endl;
 
-	while (true) {
-		if (!(*iter == *revIter)) {
-			cout << "Error! Bad reverse_iterator!" << endl;
-			cout << "*revIter = " << *revIter << ", *iter = " << *iter << endl;
-			cout << "vector = " << v << endl;
+	Vector<bool> myBits;
+	vector<bool> sysBits;
+
+	for (int i = 0, count = random(0, 500); i < count; ++i) {
+		bool bit = random(0, 3) == 0;
+		myBits.push_back(bit);
+		sysBits.push_back(bit);
+	}
+	for (int i = 0, count = random(0, 70); i < count && !sysBits.empty(); ++i) {
+		myBits.pop_back();
+		sysBits.pop_back();
+	}
+	if (!sysBits.empty()) {
+		size_t index = random(0, static_cast<int>(sysBits.size()) - 1);
+		myBits[index] = !myBits[index];
+		sysBits[index] = !sysBits[index];
+	}
+
+	if (!areEqual(sysBits, myBits) || myBits.count() != static_cast<size_t>(count(sysBits.begin(), sysBits.end(), true))) {
+		cout << "error: bad Vector<bool> contents or count()" << endl;
+		failTest();
+	}
+
+	size_t expected = find(sysBits.begin(), sysBits.end(), true) - sysBits.begin();
+	if (myBits.find_first() != expected) {
+		cout << "error: bad Vector<bool>::find_first(): " << myBits.find_first() << ", expected: " << expected << endl;
+		failTest();
+	}
+
+	Vector<bool> other;
+	for (size_t i = 0; i < sysBits.size(); ++i) {
+		other.push_back(i % 3 == 0);
+	}
+	Vector<bool> both(myBits), either(myBits);
+	both &= other;
+	either |= other;
+	myBits.flip();
+	for (size_t i = 0; i < sysBits.size(); ++i) {
+		if (both[i] != (sysBits[i] && i % 3 == 0) || either[i] != (sysBits[i] || i % 3 == 0) || myBits[i] == sysBits[i]) {
+			cout << "error: bad Vector<bool> bitwise operations at " << i << endl;
 			failTest();
 		}
-		if (iter == begin) {
-			break;
+	}
+	if (myBits.count() != sysBits.size() - count(sysBits.begin(), sysBits.end(), true)) {
+		cout << "error: Vector<bool>::flip() touched bits past the end" << endl;
+		failTest();
+	}
+
+	other.push_back(true);
+	testException<InvalidOperationException>([&](){ both &= other; }, "both &= other");
+	testException<IndexOutOfRangeException>([&](){ myBits[myBits.size()]; }, "myBits[myBits.size()]");
+	testException<IteratorOutOfRangeException>([&](){ *myBits.end(); }, "*myBits.end()");
+}
+
+void testPackedIntVector () {
+	cout << endl << ">>>" << "testPackedIntVector()" << endl;
+
+	//small values, a monotonic column and a few blocks of full-range values
+	vector<int> small, sorted, wide;
+	for (int i = 0, count = random(0, 2000); i < count; ++i) {
+		small.push_back(random(-20, 100));
+		sorted.push_back((sorted.empty() ? 1000000 : sorted.back()) + random(0, 40));
+	}
+	for (int i = 0, count = random(0, 300); i < count; ++i) {
+		wide.push_back(static_cast<int>((static_cast<unsigned>(rand()) << 16) ^ static_cast<unsigned>(rand())));
+	}
+
+	vector<int> *columns[] = { &small, &sorted, &wide };
+	for (size_t c = 0; c < 3; ++c) {
+		const vector<int> &sysVector = *columns[c];
+		PackedIntVector packed(sysVector.begin(), sysVector.end());
+
+		if (!areEqual(sysVector, packed) || !areEqual(sysVector, packed.to_vector())) {
+			cout << "error: bad PackedIntVector contents of column " << c << endl;
+			cout << "sys. vector: " << sysVector << endl;
+			cout << "decoded: " << packed.to_vector() << endl;
+			failTest();
 		}
 
-		iter--;
-		revIter++;
+		//random access after sequential reads
+		for (size_t i = 0; i < sysVector.size(); i += random(1, 200)) {
+			if (packed[i] != sysVector[i]) {
+				cout << "error: bad PackedIntVector[" << i << "] of column " << c << endl;
+				failTest();
+			}
+		}
+
+		//decode() appends after the existing elements
+		Vector<int32_t> appended(3, -1);
+		packed.decode(appended);
+		if (appended.size() != sysVector.size() + 3 || appended[2] != -1 || (!sysVector.empty() && appended[appended.size() - 1] != sysVector.back())) {
+			cout << "error: bad PackedIntVector::decode() into a non-empty vector of column " << c << endl;
+			failTest();
+		}
+
+		testException<IndexOutOfRangeException>([&](){ packed[packed.size()]; }, "packed[packed.size()]");
+	}
+
+	PackedIntVector packedSorted(sorted.begin(), sorted.end());
+	packedSorted.shrink_to_fit();
+	if (sorted.size() >= 1000 && (packedSorted.memory_usage() - sizeof(PackedIntVector)) * 3 > sorted.size() * sizeof(int)) {
+		cout << "error: PackedIntVector takes " << packedSorted.memory_usage() << " bytes for " << sorted.size() << " sorted values" << endl;
+		failTest();
 	}
 }
 
 template <typename T>
-void testIteratorUnaryIncrement () {
-	cout << endl << ">>>" << "testIteratorUnaryIncrement()" << endl;
+void testRingVector () {
+	cout << endl << ">>>" << "testRingVector()" << endl;
+
+	RingVector<T> myRing;
+	deque<T> sysRing;
+	vector<T> values;
+	fillVector(values, random(0, 300));
+
+	//interleaved pushes and pops keep the ring wrapped around
+	for (size_t i = 0; i < values.size(); ++i) {
+		myRing.push_back(values[i]);
+		sysRing.push_back(values[i]);
+		if (random(0, 2) == 0) {
+			myRing.pop_front();
+			sysRing.pop_front();
+		}
+	}
 
-	Vector<T> v1;
-	fillVector (v1, 3);
+	if (!areEqual(sysRing, myRing) || (myRing.capacity() & (myRing.capacity() - 1)) != 0) {
+		cout << "error: bad RingVector contents" << endl;
+		failTest();
+	}
 
-	Iterator<T> it = v1.begin();
-	T value1 = *(++it);
+	//iterators cross the wrap point
+	size_t index = 0;
+	for (typename RingVector<T>::const_iterator i = myRing.cbegin(); i != myRing.cend(); ++i, ++index) {
+		if (!(*i == sysRing[index])) {
+			cout << "error: bad RingVector iteration at " << index << endl;
+			failTest();
+		}
+	}
+	if (index != sysRing.size() || myRing.end() - myRing.begin() != static_cast<ptrdiff_t>(sysRing.size())) {
+		cout << "error: bad RingVector iterator distance" << endl;
+		failTest();
+	}
 
-	if (!(value1 == *(v1.begin() + 1)) || it != v1.begin() + 1) {
-		cout << "Error! bad prefix unary increment operator!" << endl;
-		cout << "value1 = " << value1 << ", *it = " << *it << ", vector = " << v1 << endl;
+	RingVector<T> copy(myRing);
+	if (!areEqual(sysRing, copy)) {
+		cout << "error: bad RingVector copy" << endl;
 		failTest();
 	}
 
-	it = v1.begin();
-	T value0 = *(it++);
+	//the move allocates no iterator containers, the moved-from ring makes them when iterated
+	int containersBefore = watcher.getContainersHostCreated();
+	RingVector<T> moved(std::move(copy));
+	if (watcher.getContainersHostCreated() != containersBefore || !copy.empty() || copy.begin() != copy.end() || !areEqual(sysRing, moved)) {
+		cout << "error: bad RingVector move" << endl;
+		failTest();
+	}
 
-	if (!(value0 == *v1.begin()) || it != v1.begin() + 1) {
-		cout << "Error! bad postfix unary increment operator!" << endl;
-		cout << "value0 = " << value0 << ", *it = " << *it << ", vector = " << v1 << endl;
+	if (!myRing.empty()) {
+		typename RingVector<T>::iterator first = myRing.begin();
+		typename RingVector<T>::iterator second = first + (myRing.size() > 1 ? 1 : 0);
+		myRing.pop_front();
+		testException<IteratorOutOfRangeException>([&](){ *first; }, "*first (popped)");
+		if (myRing.size() > 0 && !(*second == sysRing[1])) {
+			cout << "error: RingVector iterator lost its element after pop_front" << endl;
+			failTest();
+		}
+	}
+
+	typename RingVector<T>::iterator it = myRing.begin();
+	myRing.reserve(myRing.capacity() + 1);
+	testException<InvalidIteratorException>([&](){ *it; }, "*it");
+
+	myRing.clear();
+	testException<InvalidOperationException>([&](){ myRing.pop_front(); }, "myRing.pop_front()");
+	testException<IndexOutOfRangeException>([&](){ myRing[0]; }, "myRing[0]");
+}
+
+void testStaticVector () {
+	cout << endl << ">>>" << "testStaticVector()" << endl;
+
+	//heap use is operator new (iterator containers and the like) plus Vector buffers, which come from malloc in allocateStorage
+	auto heapUse = []() { return heapAllocations + static_cast<size_t>(watcher.getStorageAllocations()); };
+
+	const size_t allocationsBefore = heapUse();
+	{
+		Vector<int> values;
+		values.reserve(64);
+		size_t allocationsInside = heapUse();
+
+		StaticVector<int, 64> myVector;
+		for (int i = 0; i < 64; ++i) {
+			myVector.push_back(i * i);
+		}
+		int sum = 0;
+		for (StaticVector<int, 64>::const_iterator i = myVector.cbegin(); i != myVector.cend(); ++i) {
+			sum += *i;
+		}
+		StaticVector<int, 64> copy(myVector);
+		copy.pop_back();
+		StaticVector<int, 64, static_overflow::ReturnFalse> bounded(myVector.begin(), myVector.end());
+		bool pushed = bounded.push_back(0);
+
+		if (heapUse() != allocationsInside) {
+			cout << "error: StaticVector allocated memory " << heapUse() - allocationsInside << " times" << endl;
+			failTest();
+		}
+		if (pushed || bounded.size() != 64 || copy.size() != 63 || sum != 85344 || myVector[63] != 63 * 63) {
+			cout << "error: bad StaticVector contents" << endl;
+			failTest();
+		}
+	}
+	if (heapUse() - allocationsBefore != 3) { //the iterator containers and the reserve of 'values'
+		cout << "error: unexpected allocations around StaticVector" << endl;
+		failTest();
+	}
+
+	StaticVector<Vector<int>, 8> vectors;
+	for (int i = 0; i < 8; ++i) {
+		Vector<int> item;
+		fillVector(item, random(0, 20));
+		vectors.push_back(std::move(item));
+	}
+	StaticVector<Vector<int>, 8> moved(std::move(vectors));
+	if (!vectors.empty() || moved.size() != 8) {
+		cout << "error: bad StaticVector move" << endl;
 		failTest();
 	}
+	testException<InvalidOperationException>([&](){ moved.push_back(Vector<int>()); }, "moved.push_back() (full)");
+	testException<IndexOutOfRangeException>([&](){ moved[8]; }, "moved[8]");
+	testException<InvalidOperationException>([&](){ vectors.pop_back(); }, "vectors.pop_back() (empty)");
+
+	StaticVector<Vector<int>, 8>::iterator last = moved.end() - 1;
+	moved.pop_back();
+	testException<IteratorOutOfRangeException>([&](){ *last; }, "*last (popped)");
+
+	//iterators outlive the vector and its in-object IteratorContainer
+	StaticVector<int, 4>::iterator dangling;
+	{
+		StaticVector<int, 4> shortLived;
+		shortLived.push_back(1);
+		dangling = shortLived.begin();
+	}
+	testException<InvalidIteratorException>([&](){ *dangling; }, "*dangling");
 }
 
-template <typename T>
-void testIteratorOperations () {
-	cout << endl << ">>>" << "testIteratorOperations()" << endl;
+void testPersistentVector () {
+	cout << endl << ">>>" << "testPersistentVector()" << endl;
+
+	//every version keeps its contents: snapshots share all nodes but the changed paths
+	const int count = 40000;
+	Vector<PersistentVector<int>> versions;
+	PersistentVector<int> current;
+	for (int i = 0; i < count; ++i) {
+		current = current.push_back(i);
+		if (i % 5000 == 0) {
+			versions.push_back(current);
+		}
+	}
+	PersistentVector<int> changed = current.set(0, -1).set(count - 1, -2).set(20000, -3);
+	for (size_t v = 0; v < versions.size(); ++v) {
+		if (versions[v].size() != v * 5000 + 1 || versions[v][v * 5000] != static_cast<int>(v * 5000)) {
+			cout << "error: PersistentVector version changed" << endl;
+			failTest();
+		}
+	}
+	int index = 0;
+	for (PersistentVector<int>::const_iterator i = current.begin(); i != current.end(); ++i, ++index) {
+		if (*i != index) {
+			cout << "error: bad PersistentVector contents" << endl;
+			failTest();
+		}
+	}
+	if (index != count || changed[0] != -1 || changed[count - 1] != -2 || changed[20000] != -3 || changed[1] != 1) {
+		cout << "error: bad PersistentVector set" << endl;
+		failTest();
+	}
+	testException<IndexOutOfRangeException>([&](){ current[count]; }, "current[count]");
+	testException<IndexOutOfRangeException>([&](){ current.set(count, 0); }, "current.set(count)");
+
+	//batched edits through a transient leave the source version untouched
+	TransientVector<int> builder = current.transient();
+	for (int i = 0; i < count; ++i) {
+		builder.set(i, i * 2);
+		builder.push_back(i);
+	}
+	PersistentVector<int> built = builder.persistent();
+	builder.set(0, 7);
+	if (built.size() != 2 * count || built[count - 1] != 2 * (count - 1) || built[count] != 0 || built[0] != 0 || builder[0] != 7 || current[count - 1] != count - 1) {
+		cout << "error: bad TransientVector edits" << endl;
+		failTest();
+	}
 
-	vector<T> sys;
-	fillVector (sys, 5);
-	
-	Vector<T> v1;
-	fillVector(v1, random(3, 20));
-	Vector<T> v2;
-	fillVector(v2, random(3, 20));
+	//a copied builder edits its own nodes, the source keeps its contents
+	TransientVector<int> original;
+	for (int i = 0; i < 6; ++i) {
+		original.push_back(i);
+	}
+	TransientVector<int> copied (original);
+	copied.set(0, 42);
+	copied.push_back(100);
+	original.push_back(7);
+	copied = original;
+	copied.set(1, 43);
+	if (original.size() != 7 || original[0] != 0 || original[1] != 1 || original[6] != 7 || copied.size() != 7 || copied[1] != 43 || copied[6] != 7) {
+		cout << "error: copies of a TransientVector share their edits" << endl;
+		failTest();
+	}
 
-	testException<DifferentIteratorDomainException>([&](){ v1.begin() - v2.begin(); }, "v1.begin - v2.begin");
-	testException<DifferentIteratorDomainException>([&](){ v1.begin() >= v2.begin(); }, "v1.begin >= v2.begin");
+	//conversions from and to Vector, elements with their own memory
+	Vector<Vector<int>> source;
+	for (int i = 0; i < 100; ++i) {
+		Vector<int> item;
+		fillVector(item, random(0, 20));
+		source.push_back(item);
+	}
+	PersistentVector<Vector<int>> persistent (source);
+	PersistentVector<Vector<int>> edited = persistent.set(50, Vector<int>()).push_back(source[0]);
+	if (persistent.to_vector() != source || edited.size() != 101 || !edited[50].empty() || edited[100] != source[0]) {
+		cout << "error: bad PersistentVector conversion" << endl;
+		failTest();
+	}
+}
 
-	testException<InvalidIteratorShiftException>([&](){ v1.begin() + 1000; }, "v1.begin + 1000");
-	testException<InvalidIteratorShiftException>([&](){ v1.begin() - 1; }, "v1.begin - 1");
-	testException<InvalidIteratorShiftException>([&](){ v1.end() + 1; }, "v1.end + 1");
+void testRcuVector () {
+	cout << endl << ">>>" << "testRcuVector()" << endl;
+
+	//a guard keeps its snapshot alive across publishes
+	Vector<int> first;
+	fillVector(first, 10);
+	RcuVector<int> table (first);
+	{
+		RcuReadGuard<int> guard = table.read();
+		table.publish(Vector<int> ());
+		table.update([](Vector<int> &items) { items.push_back(42); });
+		if (*guard != first || table.retired() != 2) {
+			cout << "error: RcuVector freed a snapshot in use" << endl;
+			failTest();
+		}
+		RcuReadGuard<int> nested = table.read();
+		if (nested->size() != 1 || (*nested)[0] != 42) {
+			cout << "error: bad RcuVector publish" << endl;
+			failTest();
+		}
+	}
+	if (table.reclaim() != 2 || table.retired() != 0) {
+		cout << "error: RcuVector kept unused snapshots" << endl;
+		failTest();
+	}
 
-	//won't compile
-	//testException<ExceptionEmulator>([&](){ *v1.cbegin() = *v2.begin(); }, "*v1.cbegin = *v2.begin");
+	//readers check that every snapshot they see is whole while the writer republishes
+	const int readers = 4, versions = 300;
+	std::atomic<bool> done(false);
+	std::atomic<int> torn(0);
+	Vector<std::thread> threads;
+	for (int r = 0; r < readers; ++r) {
+		threads.push_back(std::thread([&]() {
+			while (!done.load()) {
+				RcuReadGuard<int> guard = table.read();
+				const int *items = guard->data();
+				for (size_t i = 0; i < guard->size(); ++i) {
+					if (items[i] != items[0]) {
+						++torn;
+					}
+				}
+			}
+		}));
+	}
+	for (int v = 0; v < versions; ++v) {
+		table.publish(Vector<int> (static_cast<size_t>(random(1, 1000)), v));
+	}
+	done = true;
+	for (size_t r = 0; r < threads.size(); ++r) {
+		threads[r].join();
+	}
+	table.synchronize();
+	if (torn != 0 || table.retired() != 0 || (*table.read())[0] != versions - 1) {
+		cout << "error: bad RcuVector snapshots under concurrent reads" << endl;
+		failTest();
+	}
+}
 
-	testException<ExceptionEmulator>([&](){ *v1.begin() = *v2.begin(); throw ExceptionEmulator(); }, "*v1.begin = *v2.begin");
-	testException<ExceptionEmulator>([&](){ *v1.begin() = *v2.cbegin(); throw ExceptionEmulator(); }, "*v1.begin = *v2.cbegin");
-	testException<ExceptionEmulator>([&](){ v1.end() - 1; throw ExceptionEmulator(); }, "v1.end() - 1; throw 0");
-	testException<ExceptionEmulator>([&](){ *(v1.begin() + 1); throw ExceptionEmulator(); }, "*(v1.begin + 1); throw 0");
-	testException<ExceptionEmulator>([&](){ Iterator<T> it = v1.begin(); if (*it == *v1.begin()) throw ExceptionEmulator(); else throw "!"; }, "it = v1.begin; *it == *v1.begin?");
-	testException<ExceptionEmulator>([&](){ if (1 + v1.begin() == v1.begin() + 1) throw ExceptionEmulator(); else throw "!"; }, "1 + v1.begin == v1.begin + 1");
+#ifdef SHARED_VECTOR_POSIX
+void testSharedVector () {
+	cout << endl << ">>>" << "testSharedVector()" << endl;
+
+	//a second mapping of a named region sees the elements in place
+	string name = "/VectorTester." + to_string(getpid());
+	SharedVector<int>::unlink(name);
+	{
+		SharedVector<int> producer = SharedVector<int>::create(name, 100, 1);
+		SharedVector<int> consumer = SharedVector<int>::open(name);
+		SharedVector<int>::unlink(name);
+
+		producer.begin_batch();
+		for (int i = 0; i < 100; ++i) {
+			producer.push_back(i);
+		}
+		testException<InvalidOperationException>([&](){ producer.push_back(100); }, "producer.push_back() (full)");
+		uint64_t batch = producer.publish();
 
-	testException<IteratorOutOfRangeException>([&](){ *v1.end();}, "*v1.end");
+		if (consumer.wait_batch(0) != batch || consumer.size() != 100 || consumer[99] != 99 || consumer.data() == producer.data()) {
+			cout << "error: bad SharedVector batch" << endl;
+			failTest();
+		}
+		testException<IndexOutOfRangeException>([&](){ consumer[100]; }, "consumer[100]");
+		if (producer.begin_batch(1)) {
+			cout << "error: SharedVector overwrote an unacknowledged batch" << endl;
+			failTest();
+		}
+		consumer.acknowledge();
+		if (!producer.begin_batch(1) || consumer.wait_batch(batch, 1) != 0) {
+			cout << "error: bad SharedVector handoff" << endl;
+			failTest();
+		}
+		testException<InvalidOperationException>([&](){ producer.begin_batch(); }, "producer.begin_batch() (open)");
+	}
+	testException<SharedVectorException>([&](){ SharedVector<int>::open(name); }, "open(name) (unlinked)");
+
+	//forked consumer process: reads every batch without copying, answers with its exit code
+	const int batches = 20, batchSize = 1000;
+	SharedVector<long long> channel = SharedVector<long long>::anonymous(batchSize, 1);
+	cout.flush();
+	pid_t child = fork();
+	if (child == 0) {
+		uint64_t last = 0;
+		bool ok = true;
+		for (int b = 1; b <= batches; ++b) {
+			last = channel.wait_batch(last, 10000);
+			ok = ok && last == static_cast<uint64_t>(b) && channel.size() == static_cast<size_t>(batchSize);
+			for (size_t i = 0; ok && i < channel.size(); ++i) {
+				ok = channel.data()[i] == static_cast<long long>(b) * batchSize + static_cast<long long>(i);
+			}
+			channel.acknowledge();
+		}
+		_exit(ok ? 0 : 1);
+	}
+	if (child < 0) {
+		cout << "error: fork failed" << endl;
+		failTest();
+	}
 
-	typename Vector<T>::iterator it = v1.begin();
-	v1.reserve(100);
-	testException<InvalidIteratorException>([&](){ *it; }, "*it");
+	for (int b = 1; b <= batches; ++b) {
+		if (!channel.begin_batch(10000)) {
+			break;
+		}
+		long long *items = channel.batch_data();
+		for (int i = 0; i < batchSize; ++i) {
+			items[i] = static_cast<long long>(b) * batchSize + i;
+		}
+		channel.resize_batch(batchSize);
+		channel.publish();
+	}
+	int status = 0;
+	waitpid(child, &status, 0);
+	if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+		cout << "error: consumer process got bad SharedVector batches" << endl;
+		failTest();
+	}
+}
+#endif
+
+void testContainers () {
+	testFlatSet();						watcher.checkTotalConsistency();
+	testFlatMap();						watcher.checkTotalConsistency();
+	testBitVector();					watcher.checkTotalConsistency();
+	testPackedIntVector();				watcher.checkTotalConsistency();
+	testRingVector<int>();				watcher.checkTotalConsistency();
+	testRingVector<Vector<int>>();		watcher.checkTotalConsistency();
+	testStaticVector();					watcher.checkTotalConsistency();
+	testPersistentVector();				watcher.checkTotalConsistency();
+	testRcuVector();					watcher.checkTotalConsistency();
+#ifdef SHARED_VECTOR_POSIX
+	testSharedVector();					watcher.checkTotalConsistency();
+#endif
+}
 
-	testException<InvalidIteratorException>([&](){ it == v1.begin(); }, "it == v1.begin");
+#pragma endregion
 
-	testException<IndexOutOfRangeException>([&](){ v1[1000]; }, "v1[1000]");
+#pragma region test algorithms
 
-	v1.clear();
-	testException<InvalidOperationException>([&](){ v1.pop_back(); }, "v1.pop_back()");
+void testSort () {
+	cout << endl << ">>>" << "testSort()" << endl;
+
+	vector<int> sysInts;
+	fillVector(sysInts, random(0, 1000));
+	for (size_t i = 0; i < sysInts.size(); i += 3) {
+		sysInts[i] = -sysInts[i];
+	}
+	Vector<int> myInts(sysInts.begin(), sysInts.end());
+	sort(myInts);
+	std::sort(sysInts.begin(), sysInts.end());
+	if (!areEqual(sysInts, myInts)) {
+		cout << "error: bad radix sort of ints" << endl;
+		cout << "sys. vector: " << sysInts << endl;
+		cout << "my vector: " << myInts << endl;
+		failTest();
+	}
+
+	vector<double> sysDoubles;
+	for (int i = 0, count = random(0, 1000); i < count; ++i) {
+		sysDoubles.push_back((rand() - RAND_MAX / 2) / 1000.0);
+	}
+	Vector<double> myDoubles(sysDoubles.begin(), sysDoubles.end());
+	radix_sort(myDoubles);
+	std::sort(sysDoubles.begin(), sysDoubles.end());
+	if (!areEqual(sysDoubles, myDoubles)) {
+		cout << "error: bad radix sort of doubles" << endl;
+		failTest();
+	}
+
+	//sort by key is stable: records with equal keys keep their order
+	vector<pair<int, int>> sysRecords;
+	for (int i = 0, count = random(0, 1000); i < count; ++i) {
+		sysRecords.push_back(make_pair(random(-10, 10), i));
+	}
+	Vector<pair<int, int>> myRecords(sysRecords.begin(), sysRecords.end());
+	radix_sort(myRecords, [](const pair<int, int> &record) { return record.first; });
+	stable_sort(sysRecords.begin(), sysRecords.end(), [](const pair<int, int> &a, const pair<int, int> &b) { return a.first < b.first; });
+	if (!areEqual(sysRecords, myRecords)) {
+		cout << "error: bad radix sort by key" << endl;
+		failTest();
+	}
+
+	//large enough to be split between threads
+	vector<Vector<int>> sysVectors;
+	fillVector(sysVectors, random(0, 100));
+	Vector<Vector<int>> myVectors(sysVectors.begin(), sysVectors.end());
+	std::function<bool (const Vector<int>&, const Vector<int>&)> bySize = [](const Vector<int> &a, const Vector<int> &b) { return a.size() < b.size(); };
+	parallel_sort(myVectors, bySize);
+	std::sort(sysVectors.begin(), sysVectors.end(), bySize);
+	for (size_t i = 0; i < sysVectors.size(); ++i) {
+		if (myVectors[i].size() != sysVectors[i].size()) {
+			cout << "error: bad parallel sort at " << i << endl;
+			failTest();
+		}
+	}
+
+	vector<int> sysLarge;
+	fillVector(sysLarge, sort_detail::PARALLEL_SORT_THRESHOLD * 2 + random(0, 1000));
+	Vector<int> myLarge(sysLarge.begin(), sysLarge.end());
+	parallel_sort(myLarge, greater<int>(), 3);
+	std::sort(sysLarge.begin(), sysLarge.end(), greater<int>());
+	if (!areEqual(sysLarge, myLarge)) {
+		cout << "error: bad parallel sort on 3 threads" << endl;
+		failTest();
+	}
+
+	testException<InvalidOperationException>([&](){
+		parallel_sort(myLarge, [](int a, int b) -> bool { if (a == b) throw InvalidOperationException ("equal keys"); return a < b; }, 4);
+	}, "parallel_sort with a throwing comparison");
+}
+
+void testVectorLoader () {
+	cout << endl << ">>>" << "testVectorLoader()" << endl;
+
+	const char* path = "VectorLoaderTest.tmp";
+
+	vector<int> sysVector;
+	fillVector(sysVector, random(0, 5000));
+	FILE *file = fopen(path, "wb");
+	fwrite(sysVector.data(), sizeof(int), sysVector.size(), file);
+	fclose(file);
+
+	Vector<int> myVector;
+	myVector.push_back(-1);
+	size_t loaded = VectorLoader<int>().load(path, myVector);
+	sysVector.insert(sysVector.begin(), -1);
+	if (loaded != sysVector.size() - 1 || !areEqual(sysVector, myVector)) {
+		cout << "error: bad VectorLoader::load" << endl;
+		failTest();
+	}
+
+	//small chunks: the transform runs on the caller's thread while the next chunks are read
+	Vector<int> transformed;
+	size_t chunks = 0;
+	VectorLoader<int>(random(1, 64) * sizeof(int)).load(path, transformed, [&chunks](int *records, size_t count) {
+		for (size_t i = 0; i < count; ++i) {
+			records[i] *= 2;
+		}
+		++chunks;
+	});
+	for (size_t i = 1; i < sysVector.size(); ++i) {
+		if (transformed[i - 1] != sysVector[i] * 2) {
+			cout << "error: bad VectorLoader::load with transform at " << i << endl;
+			failTest();
+		}
+	}
+
+	//a throwing transform leaves the vector as it was
+	if (sysVector.size() > 1) {
+		Vector<int> untouched;
+		testException<InvalidOperationException>([&](){
+			VectorLoader<int>(sizeof(int)).load(path, untouched, [](int*, size_t) { throw InvalidOperationException ("transform failed"); });
+		}, "load with a throwing transform");
+		if (!untouched.empty()) {
+			cout << "error: failed VectorLoader::load changed the vector" << endl;
+			failTest();
+		}
+	}
+
+	file = fopen(path, "ab");
+	fputc(0, file);
+	fclose(file);
+	testException<LoadException>([&](){ VectorLoader<int>().load(path, myVector); }, "load of a file with a partial record");
+
+	remove(path);
+	testException<LoadException>([&](){ VectorLoader<int>().load(path, myVector); }, "load of a missing file");
+}
+
+#ifdef VECTOR_CXX20
+//The table is built at compile time by transient Vectors: every allocation and iterator container is freed
+//before the constant evaluation ends.
+template <size_t N>
+constexpr std::array<int, N> makeSquaresTable () {
+	Vector<int> squares;
+	for (int i = 0; i < static_cast<int>(N); ++i) {
+		squares.push_back(i * i);
+	}
+
+	Vector<int> copy(squares);
+	copy.pop_back();
+	copy.push_back(squares[N - 1]);
+
+	std::array<int, N> table {};
+	size_t index = 0;
+	for (int value : copy) {
+		table[index++] = value;
+	}
+	return table;
+}
+
+constexpr std::array<int, 100> squaresTable = makeSquaresTable<100>();
+static_assert(squaresTable[0] == 0 && squaresTable[7] == 49 && squaresTable[99] == 9801, "Vector must be usable in constant evaluation");
+#endif
+
+void testConstexprVector () {
+	cout << endl << ">>>" << "testConstexprVector()" << endl;
+
+	#ifdef VECTOR_CXX20
+	//the same function at run time
+	std::array<int, 100> runtimeTable = makeSquaresTable<100>();
+	if (runtimeTable != squaresTable) {
+		cout << "error: compile-time table differs from the run-time one" << endl;
+		failTest();
+	}
+	#endif
+}
+
+void testHash () {
+	cout << endl << ">>>" << "testHash()" << endl;
+
+	//raw byte hash: equal contents - equal hashes, lengths of 0..40 cover the 32-byte lanes and the tails
+	unordered_map<Vector<int>, size_t> counts;
+	for (size_t length = 0; length <= 40; ++length) {
+		Vector<int> key;
+		for (size_t i = 0; i < length; ++i) {
+			key.push_back(static_cast<int>(i * 7));
+		}
+		counts[key] = length;
+
+		Vector<int> copy(key);
+		if (hash<Vector<int>>()(copy) != hash<Vector<int>>()(key) || counts[copy] != length) {
+			cout << "error: equal vectors have different hashes" << endl;
+			failTest();
+		}
+	}
+	if (counts.size() != 41) {
+		cout << "error: bad unordered_map of vectors" << endl;
+		failTest();
+	}
+
+	Vector<int> a(16, 1);
+	Vector<int> b(16, 1);
+	b[15] = 2;
+	if (hash<Vector<int>>()(a) == hash<Vector<int>>()(b)) {
+		cout << "error: hash ignores the last element" << endl;
+		failTest();
+	}
+
+	//element hashes: equal strings may have different bytes
+	Vector<string> strings;
+	strings.push_back(string("key"));
+	Vector<string> sameStrings(strings);
+	Vector<bool> bits(70, true);
+	Vector<bool> sameBits(bits);
+	if (hash<Vector<string>>()(strings) != hash<Vector<string>>()(sameStrings) || hash<Vector<bool>>()(bits) != hash<Vector<bool>>()(sameBits)) {
+		cout << "error: bad fallback hash" << endl;
+		failTest();
+	}
+
+	HashedVector<int> hashed(a);
+	size_t first = hashed.hash();
+	if (!hashed.hash_cached() || first != hash<Vector<int>>()(a)) {
+		cout << "error: bad cached hash" << endl;
+		failTest();
+	}
+	hashed.modify()->push_back(3);
+	if (hashed.hash_cached() || hashed.hash() == first || HashedVector<int>(a) == hashed) {
+		cout << "error: cached hash is not invalidated" << endl;
+		failTest();
+	}
+
+	//a hash taken in the middle of a modification is not kept after it
+	{
+		HashedVectorModification<int> modification = hashed.modify();
+		modification->push_back(4);
+		hashed.hash();
+		modification->push_back(5);
+	}
+	if (hashed.hash_cached() || hashed.hash() != hash<Vector<int>>()(hashed.get())) {
+		cout << "error: stale hash kept after modification" << endl;
+		failTest();
+	}
+}
+
+void testAlgorithms () {
+	testSort();							watcher.checkTotalConsistency();
+	testVectorLoader();					watcher.checkTotalConsistency();
+	testConstexprVector();				watcher.checkTotalConsistency();
+	testHash();							watcher.checkTotalConsistency();
 }
 
 #pragma endregion
@@ -816,19 +2422,30 @@ void test () {
 	testCopyConstructor<T>();			watcher.checkTotalConsistency();
 	testMoveConstructor<T>();			watcher.checkTotalConsistency();
 	testIteratorConstructor<T>();		watcher.checkTotalConsistency();
+	testFillConstructor<T>();			watcher.checkTotalConsistency();
 	testSetOperatorLValue<T>();			watcher.checkTotalConsistency();
 	testSetOperatorRValue<T>();			watcher.checkTotalConsistency();
 	testPopBack<T>();					watcher.checkTotalConsistency();
+	testTruncate<T>();					watcher.checkTotalConsistency();
+	testTryOperations<T>();				watcher.checkTotalConsistency();
 	testPushBackLValue<T>();			watcher.checkTotalConsistency();
 	testPushBackRValue<T>();			watcher.checkTotalConsistency();
 	testReserveAndShrinkToFit<T>();		watcher.checkTotalConsistency();
 	testSwap<T>();						watcher.checkTotalConsistency();
 	testClear<T>();						watcher.checkTotalConsistency();
+	testStorageOptions<T>();			watcher.checkTotalConsistency();
+	testMappedStorage<T>();				watcher.checkTotalConsistency();
+	testRecycledStorage<T>();			watcher.checkTotalConsistency();
+	testSizingHints<T>();				watcher.checkTotalConsistency();
+	testViews<T>();						watcher.checkTotalConsistency();
 
 	testIteratorValidity<T>();			watcher.checkTotalConsistency();
 	testRangedFor<T>();					watcher.checkTotalConsistency();
+	testChunks<T>();					watcher.checkTotalConsistency();
+	testCheckedRange<T>();				watcher.checkTotalConsistency();
 	testIteratorCasts<T>();				watcher.checkTotalConsistency();
 	testIteratorTraits<T>();			watcher.checkTotalConsistency();
+	testContiguousIterators<T>();		watcher.checkTotalConsistency();
 	testIteratorOperations<T>();		watcher.checkTotalConsistency();
 	testIteratorUnaryIncrement<T>();	watcher.checkTotalConsistency();
 	testReverseIterators<T>();			watcher.checkTotalConsistency();
@@ -842,13 +2459,23 @@ void test<TypeUncopiable> () {
 	testMoveConstructor<T>();			watcher.checkTotalConsistency();
 	testSetOperatorRValue<T>();			watcher.checkTotalConsistency();
 	testPopBack<T>();					watcher.checkTotalConsistency();
+	testTruncate<T>();					watcher.checkTotalConsistency();
 	testPushBackRValue<T>();			watcher.checkTotalConsistency();
+	testReserveAndShrinkToFit<T>();		watcher.checkTotalConsistency();
 	testSwap<T>();						watcher.checkTotalConsistency();
 	testClear<T>();						watcher.checkTotalConsistency();
+	testStorageOptions<T>();			watcher.checkTotalConsistency();
+	testMappedStorage<T>();				watcher.checkTotalConsistency();
+	testRecycledStorage<T>();			watcher.checkTotalConsistency();
+	testSizingHints<T>();				watcher.checkTotalConsistency();
+	testViews<T>();						watcher.checkTotalConsistency();
 
 	testRangedFor<T>();					watcher.checkTotalConsistency();
+	testChunks<T>();					watcher.checkTotalConsistency();
+	testCheckedRange<T>();				watcher.checkTotalConsistency();
 	testIteratorCasts<T>();				watcher.checkTotalConsistency();
 	testIteratorTraits<T>();			watcher.checkTotalConsistency();
+	testContiguousIterators<T>();		watcher.checkTotalConsistency();
 	testReverseIterators<T>();			watcher.checkTotalConsistency();
 }
 
@@ -868,6 +2495,12 @@ int main() {
 		cout << endl << "Testing Vector<TypeUncopiable>" << endl;
 		test<TypeUncopiable>();
 
+		cout << endl << "Testing containers" << endl;
+		testContainers();
+
+		cout << endl << "Testing algorithms" << endl;
+		testAlgorithms();
+
 		cout << endl << "Testing over" << endl;
 	}
 
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include "Vector.h"
+
+#if defined(_MSC_FULL_VER) && _MSC_FULL_VER < 180000000
+#define noexcept throw()
+#endif
+
+struct InvalidViewException : public ExceptionWithMessage {
+	explicit InvalidViewException (const char* msg) : ExceptionWithMessage(msg) { }
+	InvalidViewException () : ExceptionWithMessage ("View is used after its vector was reallocated or destroyed") { }
+};
+
+///<summary>
+///Unchecked random access iterator over elements placed 'stride' elements apart.
+///With stride 1 it is a plain pointer walk.
+///</summary>
+template <typename T>
+class StridedIterator {
+private:
+	T *ptr;
+	ptrdiff_t stride;
+
+public:
+	typedef std::random_access_iterator_tag iterator_category;
+	typedef typename std::remove_const<T>::type value_type;
+	typedef ptrdiff_t difference_type;
+	typedef T* pointer;
+	typedef T& reference;
+
+	StridedIterator () noexcept : ptr(nullptr), stride(1) { }
+	StridedIterator (T *ptr, ptrdiff_t stride) noexcept : ptr(ptr), stride(stride) { }
+
+	T& operator* () const noexcept { return *ptr; }
+	T* operator-> () const noexcept { return ptr; }
+	T& operator[] (ptrdiff_t offset) const noexcept { return ptr[offset * stride]; }
+
+	StridedIterator& operator++ () noexcept { ptr += stride; return *this; }
+	StridedIterator operator++ (int) noexcept { StridedIterator clone(*this); ptr += stride; return clone; }
+	StridedIterator& operator-- () noexcept { ptr -= stride; return *this; }
+	StridedIterator operator-- (int) noexcept { StridedIterator clone(*this); ptr -= stride; return clone; }
+
+	StridedIterator& operator+= (ptrdiff_t offset) noexcept { ptr += offset * stride; return *this; }
+	StridedIterator& operator-= (ptrdiff_t offset) noexcept { ptr -= offset * stride; return *this; }
+	StridedIterator operator+ (ptrdiff_t offset) const noexcept { return StridedIterator(ptr + offset * stride, stride); }
+	StridedIterator operator- (ptrdiff_t offset) const noexcept { return StridedIterator(ptr - offset * stride, stride); }
+	ptrdiff_t operator- (const StridedIterator &another) const noexcept { return (ptr - another.ptr) / stride; }
+
+	bool operator== (const StridedIterator &another) const noexcept { return ptr == another.ptr; }
+	bool operator!= (const StridedIterator &another) const noexcept { return ptr != another.ptr; }
+	bool operator< (const StridedIterator &another) const noexcept { return stride > 0 ? ptr < another.ptr : ptr > another.ptr; }
+	bool operator> (const StridedIterator &another) const noexcept { return another < *this; }
+	bool operator<= (const StridedIterator &another) const noexcept { return !(another < *this); }
+	bool operator>= (const StridedIterator &another) const noexcept { return !(*this < another); }
+
+	friend StridedIterator operator+ (ptrdiff_t offset, const StridedIterator &iter) noexcept { return iter + offset; }
+};
+
+///<summary>
+///Non-owning view of a Vector range: pointer, length and stride.
+///Copying a view is free: no iterator registration takes place.
+///The view becomes dangling when its vector reallocates (reserve, push_back over capacity, swap, clear...).
+///With VIEW_CHECK_MODE defined, the view keeps a registered iterator of its vector
+///and throws InvalidViewException when used after reallocation.
+///</summary>
+template <typename T>
+class VectorView {
+private:
+	typedef typename std::remove_const<T>::type ValueType;
+
+	T *first;
+	size_t length;
+	ptrdiff_t stride;
+
+	#ifdef VIEW_CHECK_MODE
+	ConstIterator<ValueType> anchor; //becomes invalid together with all iterators of the vector
+	#endif
+
+	template <typename T2>
+	friend class VectorView;
+
+	friend class Vector<ValueType>;
+
+	#ifdef VIEW_CHECK_MODE
+	VectorView (T *first, size_t length, ptrdiff_t stride, const ConstIterator<ValueType> &anchor)
+		: first(first), length(length), stride(stride), anchor(anchor) { }
+	#else
+	VectorView (T *first, size_t length, ptrdiff_t stride) noexcept
+		: first(first), length(length), stride(stride) { }
+	#endif
+
+	//throws InvalidViewException if the vector was reallocated. No-op without VIEW_CHECK_MODE.
+	void checkValidity () const {
+		#ifdef VIEW_CHECK_MODE
+		if (length && !static_cast<const BaseIterator<const ValueType, ConstIterator<ValueType>, Vector<ValueType>>&>(anchor).isValid()) {
+			VECTOR_THROW(InvalidViewException());
+		}
+		#endif
+	}
+
+public:
+	typedef StridedIterator<T> iterator;
+	typedef StridedIterator<T> const_iterator;
+
+	VectorView () noexcept : first(nullptr), length(0), stride(1) { }
+
+	//VectorView<T> -> VectorView<const T>
+	template <typename T2>
+	VectorView (const VectorView<T2> &other, typename std::enable_if<std::is_convertible<T2*, T*>::value>::type* = nullptr)
+		: first(other.first), length(other.length), stride(other.stride)
+		#ifdef VIEW_CHECK_MODE
+		, anchor(other.anchor)
+		#endif
+	{ }
+
+	size_t size () const noexcept { return length; }
+	bool empty () const noexcept { return length == 0; }
+	ptrdiff_t step () const noexcept { return stride; }
+	bool contiguous () const noexcept { return stride == 1; }
+
+	//first element; with contiguous() the whole view is [data(), data() + size())
+	T* data () const {
+		checkValidity();
+		return first;
+	}
+
+	T& operator[] (size_t index) const {
+		if (index >= length) {
+			VECTOR_THROW(IndexOutOfRangeException ("Index out of range"));
+		}
+		checkValidity();
+
+		return first[static_cast<ptrdiff_t>(index) * stride];
+	}
+
+	//'count' elements starting at 'offset', taking every 'step'-th one
+	VectorView<T> subview (size_t offset, size_t count, size_t step = 1) const {
+		if (count && (step == 0 || offset >= length || (count - 1) > (length - 1 - offset) / step)) {
+			VECTOR_THROW(IndexOutOfRangeException ("Subview out of range"));
+		}
+		checkValidity();
+
+		VectorView<T> result(*this);
+		result.first = count ? first + static_cast<ptrdiff_t>(offset) * stride : nullptr;
+		result.length = count;
+		result.stride = stride * static_cast<ptrdiff_t>(step);
+		return result;
+	}
+
+	//validated once here, the iteration itself is unchecked
+	iterator begin () const {
+		checkValidity();
+		return iterator (first, stride);
+	}
+
+	iterator end () const {
+		checkValidity();
+		return iterator (first + static_cast<ptrdiff_t>(length) * stride, stride);
+	}
+};
+
+#if !defined(_MSC_FULL_VER) || _MSC_FULL_VER >= 180000000
+template <typename T>
+using ConstVectorView = VectorView<const T>;
+#endif
+
+#pragma region Vector views implementation
+
+template <typename T>
+VectorView<T> Vector<T>::view (size_t offset, size_t count, size_t step) {
+	if (count && (step == 0 || offset >= size() || (count - 1) > (size() - 1 - offset) / step)) {
+		VECTOR_THROW(IndexOutOfRangeException ("View out of range"));
+	}
+
+	T *first = count ? memory_begin + offset : nullptr;
+
+	#ifdef VIEW_CHECK_MODE
+	return VectorView<T> (first, count, static_cast<ptrdiff_t>(step), cbegin());
+	#else
+	return VectorView<T> (first, count, static_cast<ptrdiff_t>(step));
+	#endif
+}
+
+template <typename T>
+VectorView<const T> Vector<T>::view (size_t offset, size_t count, size_t step) const {
+	if (count && (step == 0 || offset >= size() || (count - 1) > (size() - 1 - offset) / step)) {
+		VECTOR_THROW(IndexOutOfRangeException ("View out of range"));
+	}
+
+	const T *first = count ? memory_begin + offset : nullptr;
+
+	#ifdef VIEW_CHECK_MODE
+	return VectorView<const T> (first, count, static_cast<ptrdiff_t>(step), cbegin());
+	#else
+	return VectorView<const T> (first, count, static_cast<ptrdiff_t>(step));
+	#endif
+}
+
+#pragma endregion